@@ -0,0 +1,285 @@
+#include "reactionengine.h"
+#include "depiction.h"
+#include "moleculereader.h"
+
+#include <GraphMol/ChemReactions/ReactionParser.h>
+#include <GraphMol/SmilesParse/SmilesWrite.h>
+#include <RDGeneral/versions.h>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Benchmarks of the enumeration and bridge generation hot paths over a fixed
+// set of monomers. Every stage is timed on its own, call by call, and the
+// results are printed as one JSON document so they can be tracked over time.
+
+#ifndef DIMER_BENCH_MONOMERS
+#define DIMER_BENCH_MONOMERS "bench/monomers.smi"
+#endif
+
+namespace {
+    // Biaryl coupling, the simplest dimerisation there is
+    const char *bench_reaction = "([cH1:1]).([cH1:2])>>[c:1]-[c:2]";
+
+    struct Options {
+        std::string monomers = DIMER_BENCH_MONOMERS;
+        std::string output;
+        std::string filter;
+        double minTime = 0.5;
+        size_t minCalls = 5;
+    };
+
+    struct Result {
+        std::string benchmark;
+        std::string monomer;
+        size_t calls;
+        double seconds;
+        std::vector<double> latencies; // Microseconds, sorted
+        long peakRssKb;
+    };
+
+    long peak_rss_kb(){
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    double percentile(const std::vector<double> &sorted, double p){
+        if(sorted.empty()){
+            return 0;
+        }
+        size_t idx = std::min(sorted.size() - 1, size_t(p / 100 * sorted.size()));
+        return sorted[idx];
+    }
+
+    // Calls fn until both minTime seconds and minCalls calls are reached, after one warm-up call
+    template<typename F>
+    Result measure(const Options &opts, const std::string &benchmark, const std::string &monomer, F fn){
+        typedef std::chrono::steady_clock clock;
+        fn();
+
+        Result res{benchmark, monomer, 0, 0, {}, 0};
+        auto start = clock::now();
+        while(res.calls < opts.minCalls || res.seconds < opts.minTime){
+            auto t0 = clock::now();
+            fn();
+            auto t1 = clock::now();
+            res.latencies.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+            res.calls ++;
+            res.seconds = std::chrono::duration<double>(t1 - start).count();
+        }
+        std::sort(res.latencies.begin(), res.latencies.end());
+        res.peakRssKb = peak_rss_kb();
+        return res;
+    }
+
+    std::string json_string(const std::string &s){
+        std::string res = "\"";
+        for(char c: s){
+            if(c == '"' || c == '\\'){
+                res += '\\';
+            }
+            res += c;
+        }
+        return res + "\"";
+    }
+
+    void write_json(std::ostream &out, const Options &opts, const std::vector<Result> &results){
+        out << std::fixed << std::setprecision(3);
+        out << "{\n"
+            << "  \"format\": 1,\n"
+            << "  \"rdkit\": " << json_string(RDKit::rdkitVersion) << ",\n"
+            << "  \"threads\": " << std::thread::hardware_concurrency() << ",\n"
+            << "  \"monomers\": " << json_string(opts.monomers) << ",\n"
+            << "  \"min_time_s\": " << opts.minTime << ",\n"
+            << "  \"results\": [";
+        for(size_t i = 0; i < results.size(); i ++){
+            const Result &r = results[i];
+            out << (i ? "," : "") << "\n    {"
+                << "\"benchmark\": " << json_string(r.benchmark)
+                << ", \"monomer\": " << json_string(r.monomer)
+                << ", \"calls\": " << r.calls
+                << ", \"throughput_per_s\": " << r.calls / r.seconds
+                << ", \"latency_us\": {"
+                << "\"min\": " << r.latencies.front()
+                << ", \"p50\": " << percentile(r.latencies, 50)
+                << ", \"p90\": " << percentile(r.latencies, 90)
+                << ", \"p99\": " << percentile(r.latencies, 99)
+                << ", \"max\": " << r.latencies.back()
+                << "}, \"peak_rss_kb\": " << r.peakRssKb << "}";
+        }
+        out << "\n  ],\n"
+            << "  \"peak_rss_kb\": " << peak_rss_kb() << "\n"
+            << "}\n";
+    }
+
+    // Bond indices of the first and last C-H bonds of the hydrogen-complete molecule
+    bool first_last_ch_bonds(const RDKit::ROMol &hmol, unsigned int &idx1, unsigned int &idx2){
+        std::vector<unsigned int> bonds;
+        for(const auto bond: hmol.bonds()){
+            int a = bond->getBeginAtom()->getAtomicNum(), b = bond->getEndAtom()->getAtomicNum();
+            if((a == 6 && b == 1) || (a == 1 && b == 6)){
+                bonds.push_back(bond->getIdx());
+            }
+        }
+        if(bonds.size() < 2){
+            return false;
+        }
+        idx1 = bonds.front();
+        idx2 = bonds.back();
+        return true;
+    }
+
+    void print_usage(const char *prog){
+        std::cerr << "Usage: " << prog << " [options]\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  -m, --monomers FILE    monomer set, defaults to the checked-in " << DIMER_BENCH_MONOMERS << "\n"
+                  << "  -o, --output FILE      write the JSON report to FILE instead of stdout\n"
+                  << "  -f, --filter NAME      only run benchmarks whose name contains NAME\n"
+                  << "  -t, --min-time SECONDS time spent on each benchmark and monomer, default 0.5\n"
+                  << "  -n, --min-calls N      calls made for each benchmark and monomer at least, default 5\n"
+                  << "  -h, --help             show this message\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options opts;
+    for(int i = 1; i < argc; i ++){
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        // A value that is not a number ends in the usage message
+        try{
+            if(arg == "-h" || arg == "--help"){
+                print_usage(argv[0]);
+                return 0;
+            }
+            else if((arg == "-m" || arg == "--monomers") && hasValue){
+                opts.monomers = argv[++i];
+            }
+            else if((arg == "-o" || arg == "--output") && hasValue){
+                opts.output = argv[++i];
+            }
+            else if((arg == "-f" || arg == "--filter") && hasValue){
+                opts.filter = argv[++i];
+            }
+            else if((arg == "-t" || arg == "--min-time") && hasValue){
+                opts.minTime = std::stod(argv[++i]);
+            }
+            else if((arg == "-n" || arg == "--min-calls") && hasValue){
+                opts.minCalls = std::stoul(argv[++i]);
+            }
+            else{
+                std::cerr << "Unknown or incomplete option " << arg << "\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        catch(const std::invalid_argument &){
+            std::cerr << "Invalid value " << argv[i] << " for " << arg << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+        catch(const std::out_of_range &){
+            std::cerr << "Value " << argv[i] << " for " << arg << " is out of range\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<InputMolecule> mols;
+    bool badRecords = false;
+    read_molecules(opts.monomers, [&](ReadBatch &batch){
+        for(auto &m: batch.molecules){
+            mols.push_back(std::move(m));
+        }
+        for(const auto &e: batch.errors){
+            std::cerr << "Cannot read " << e.file << ", record " << e.record << ": " << e.message << "\n";
+            badRecords = true;
+        }
+        return true;
+    });
+    if(mols.empty() || badRecords){
+        std::cerr << "The benchmark set " << opts.monomers << " must be complete and readable\n";
+        return 1;
+    }
+
+    RXN_SPTR rxn(RDKit::RxnSmartsToChemicalReaction(bench_reaction));
+    rxn->initReactantMatchers();
+
+    auto wanted = [&opts](const std::string &benchmark){
+        return opts.filter.empty() || benchmark.find(opts.filter) != std::string::npos;
+    };
+
+    std::vector<Result> results;
+    for(const auto &m: mols){
+        PREPARED_SPTR prepared = prepare_reactant(m.mol);
+        auto products = run_reaction_with_symm(rxn, *prepared);
+
+        if(wanted("unique_atoms")){
+            results.push_back(measure(opts, "unique_atoms", m.name, [&](){
+                unique_atoms(m.mol);
+            }));
+        }
+        if(wanted("run_reaction_with_symm")){
+            results.push_back(measure(opts, "run_reaction_with_symm", m.name, [&](){
+                run_reaction_with_symm(rxn, *prepared);
+            }));
+        }
+        if(wanted("generate_bridges")){
+            results.push_back(measure(opts, "generate_bridges", m.name, [&](){
+                generate_bridges(*prepared); // Fresh key cache on every call
+            }));
+        }
+        RDKit::ROMOL_SPTR hmol(RDKit::MolOps::addHs(*prepared->reactant));
+        unsigned int idx1, idx2;
+        if(wanted("mol_to_reaction") && first_last_ch_bonds(*hmol, idx1, idx2)){
+            results.push_back(measure(opts, "mol_to_reaction", m.name, [&](){
+                mol_to_reaction(prepared->reactant, idx1, idx2);
+            }));
+        }
+        if(products.empty()){
+            continue;
+        }
+        if(wanted("canonicalize")){
+            // All dimers of the monomer per call
+            results.push_back(measure(opts, "canonicalize", m.name, [&](){
+                for(const auto &p: products){
+                    RDKit::MolToSmiles(*p.second);
+                }
+            }));
+        }
+        if(wanted("depiction")){
+            // The product with the smallest key, so every run depicts the same one
+            auto first = std::min_element(products.begin(), products.end(), [](const auto &a, const auto &b){
+                return a.first < b.first;
+            });
+            const RDKit::ROMol &product = *first->second;
+            results.push_back(measure(opts, "depiction", m.name, [&](){
+                prepare_depiction(product);
+            }));
+        }
+    }
+
+    if(opts.output.empty()){
+        write_json(std::cout, opts, results);
+        return 0;
+    }
+    std::ofstream out(opts.output);
+    if(!out){
+        std::cerr << "Cannot open " << opts.output << " for writing\n";
+        return 1;
+    }
+    write_json(out, opts, results);
+    return 0;
+}
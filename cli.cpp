@@ -0,0 +1,650 @@
+#include "reactionengine.h"
+#include "productregistry.h"
+#include "moleculereader.h"
+#include "productwriter.h"
+#include "resultcache.h"
+#include "instrumentation.h"
+#include "parallel.h"
+#include "shardmanifest.h"
+#include "reactionlibrary.h"
+
+#include <GraphMol/ChemReactions/ReactionParser.h>
+#include <GraphMol/SmilesParse/SmilesWrite.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headless batch driver: reads monomers, runs every reaction on every monomer
+// and streams the products as "SMILES<TAB>monomer<TAB>reaction" lines.
+
+namespace {
+    void print_usage(const char *prog){
+        std::cerr << "Usage: " << prog << " [options] <molecule file or directory>...\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  -r, --reaction SMARTS  add a reaction given as reaction SMARTS\n"
+                  << "  -b, --bridges PATH     generate bridge reactions from the molecule file or directory PATH\n"
+                  << "  -i, --import PATH      add the reactions of a reaction SMARTS list, an .rxn file or a directory of them\n"
+                  << "  -l, --library FILE     add the reactions of a reaction library or project\n"
+                  << "      --save-library FILE save every reaction given to a reaction library, without molecules nothing else is done\n"
+                  << "  -o, --output FILE      write products to FILE instead of stdout, .sdf and .gz are recognized\n"
+                  << "  -p, --provenance FILE  write every (product, monomer, reaction) that was produced to FILE\n"
+                  << "  -s, --report FILE      write per-stage timings and the cost of every monomer and reaction to FILE as JSON\n"
+                  << "  -c, --cache DIR        reuse the products of (reaction, monomer) pairs computed by earlier runs, kept in DIR\n"
+                  << "  -n, --length N         grow oligomers of up to N monomer units, default 2 for dimers\n"
+                  << "  -x, --cross            join every unordered pair of molecules instead of each molecule with itself\n"
+                  << "      --max-frontier N    expand at most N new oligomers of each length\n"
+                  << "      --max-heavy-atoms N drop products with more than N heavy atoms\n"
+                  << "      --max-rings N       drop products with more than N rings\n"
+                  << "      --max-mw WEIGHT     drop products heavier than WEIGHT\n"
+                  << "  -t, --threads N        run on N threads, default all cores, or per shard process with --local\n"
+                  << "  -h, --help             show this message\n"
+                  << "\n"
+                  << "Sharded runs:\n"
+                  << "      --shards N --manifest FILE  split the run into N shards planned in FILE, -o names the merged output\n"
+                  << "      --manifest FILE --shard K   run shard K, K = auto takes the index of a batch array job\n"
+                  << "      --manifest FILE --local J   run every incomplete shard, J processes at a time, then merge\n"
+                  << "      --manifest FILE --merge     merge the shard files into -o or the planned output, each product once\n";
+    }
+
+    void print_read_errors(const std::vector<ReadError> &errors){
+        for(const auto &e: errors){
+            std::cerr << "Cannot read " << e.file;
+            if(e.record){
+                std::cerr << ", record " << e.record << " at line " << e.line;
+            }
+            std::cerr << ": " << e.message << "\n";
+        }
+    }
+
+    // A cell whose reaction threw is counted and reported, the run goes on with the others
+    void report_failure(RunStats &stats, const std::string &reaction, const std::string &monomer, const std::exception &e){
+        stats.add_failure();
+        // One write per message, so lines of concurrent cells do not interleave
+        std::cerr << ("Reaction " + reaction + " failed on " + monomer + ": " + e.what() + "\n");
+    }
+
+    // Reads a monomer library, every bad record is reported with its location
+    void read_inputs(const std::string &path, std::vector<InputMolecule> &mols){
+        read_molecules(path, [&mols](ReadBatch &batch){
+            for(auto &m: batch.molecules){
+                mols.push_back(std::move(m));
+            }
+            print_read_errors(batch.errors);
+            return true;
+        });
+    }
+
+    struct Options {
+        std::vector<std::string> inputs, bridges;
+        ReactionLibrary reactions; // Of -r, -i and -l in command line order, each reaction once
+        std::string output, provenance, cacheDir, report, saveLibrary;
+        ProductFilter filter;
+        OligomerOptions oligomers;
+        bool crossPairs = false;
+        unsigned int threads = 0; // 0 for all cores
+
+        std::string manifest, shard;
+        size_t shards = 0, localJobs = 0;
+        bool merge = false;
+        std::vector<std::string> runArgs; // Options deciding which products are made, paths made absolute
+    };
+
+    // Returns false when main has to stop right away with exitCode
+    bool parse_args(const std::vector<std::string> &args, Options &opts, const char *prog, int &exitCode){
+        exitCode = 1;
+        for(size_t i = 0; i < args.size(); i ++){
+            const std::string &arg = args[i];
+            bool hasValue = i + 1 < args.size();
+            size_t first = i;
+            // A value that is not a number ends in the usage message
+            try{
+                if(arg == "-h" || arg == "--help"){
+                    print_usage(prog);
+                    exitCode = 0;
+                    return false;
+                }
+                else if((arg == "-r" || arg == "--reaction") && hasValue){
+                    std::string smarts = args[++i];
+                    RXN_SPTR rxn;
+                    try{
+                        rxn.reset(RDKit::RxnSmartsToChemicalReaction(smarts));
+                    }
+                    catch(const RDKit::ChemicalReactionParserException &e){
+                        std::cerr << "Invalid reaction SMARTS " << smarts << ": " << e.what() << "\n";
+                        return false;
+                    }
+                    if(!rxn){
+                        std::cerr << "Invalid reaction SMARTS " << smarts << "\n";
+                        return false;
+                    }
+                    rxn->initReactantMatchers();
+                    opts.reactions.add(smarts, rxn);
+                }
+                else if((arg == "-i" || arg == "--import") && hasValue){
+                    // Parsed right away so reactions keep the order of the command line
+                    std::vector<ReadError> errors;
+                    opts.reactions.import(args[++i], errors, opts.threads);
+                    print_read_errors(errors);
+                    // Bad records are skipped, but a file that cannot be read at all stops the run like -l does
+                    for(const auto &e: errors){
+                        if(!e.record){
+                            return false;
+                        }
+                    }
+                    opts.runArgs.push_back(arg);
+                    opts.runArgs.push_back(std::filesystem::absolute(args[i]).string());
+                    continue;
+                }
+                else if((arg == "-l" || arg == "--library") && hasValue){
+                    std::string error;
+                    if(!opts.reactions.load(args[++i], error, opts.threads)){
+                        std::cerr << error << "\n";
+                        return false;
+                    }
+                    opts.runArgs.push_back(arg);
+                    opts.runArgs.push_back(std::filesystem::absolute(args[i]).string());
+                    continue;
+                }
+                else if(arg == "--save-library" && hasValue){
+                    opts.saveLibrary = args[++i];
+                    continue;
+                }
+                else if((arg == "-b" || arg == "--bridges") && hasValue){
+                    // A manifest lists the bridge reactions themselves
+                    opts.bridges.push_back(args[++i]);
+                    continue;
+                }
+                else if((arg == "-o" || arg == "--output") && hasValue){
+                    opts.output = args[++i];
+                    continue;
+                }
+                else if((arg == "-p" || arg == "--provenance") && hasValue){
+                    opts.provenance = args[++i];
+                    continue;
+                }
+                else if((arg == "-s" || arg == "--report") && hasValue){
+                    opts.report = args[++i];
+                    continue;
+                }
+                else if((arg == "-c" || arg == "--cache") && hasValue){
+                    opts.cacheDir = args[++i];
+                    opts.runArgs.push_back(arg);
+                    opts.runArgs.push_back(std::filesystem::absolute(opts.cacheDir).string());
+                    continue;
+                }
+                else if((arg == "-n" || arg == "--length") && hasValue){
+                    opts.oligomers.maxLength = std::stoul(args[++i]);
+                }
+                else if(arg == "-x" || arg == "--cross"){
+                    opts.crossPairs = true;
+                }
+                else if(arg == "--max-frontier" && hasValue){
+                    opts.oligomers.maxFrontier = std::stoul(args[++i]);
+                }
+                else if(arg == "--max-heavy-atoms" && hasValue){
+                    opts.filter.maxHeavyAtoms = std::stoul(args[++i]);
+                }
+                else if(arg == "--max-rings" && hasValue){
+                    opts.filter.maxRings = std::stoul(args[++i]);
+                }
+                else if(arg == "--max-mw" && hasValue){
+                    opts.filter.maxMolWt = std::stod(args[++i]);
+                }
+                else if((arg == "-t" || arg == "--threads") && hasValue){
+                    // Only how the run is spread, so not replayed by shards
+                    opts.threads = std::stoul(args[++i]);
+                    continue;
+                }
+                else if(arg == "--shards" && hasValue){
+                    opts.shards = std::stoul(args[++i]);
+                    continue;
+                }
+                else if(arg == "--manifest" && hasValue){
+                    opts.manifest = args[++i];
+                    continue;
+                }
+                else if(arg == "--shard" && hasValue){
+                    opts.shard = args[++i];
+                    continue;
+                }
+                else if(arg == "--local" && hasValue){
+                    opts.localJobs = std::max<size_t>(1, std::stoul(args[++i]));
+                    continue;
+                }
+                else if(arg == "--merge"){
+                    opts.merge = true;
+                    continue;
+                }
+                else if(!arg.empty() && arg[0] == '-'){
+                    std::cerr << "Unknown or incomplete option " << arg << "\n";
+                    print_usage(prog);
+                    return false;
+                }
+                else{
+                    opts.inputs.push_back(arg);
+                    opts.runArgs.push_back(std::filesystem::absolute(arg).string());
+                    continue;
+                }
+            }
+            catch(const std::invalid_argument &){
+                std::cerr << "Invalid value " << args[i] << " for " << arg << "\n";
+                print_usage(prog);
+                return false;
+            }
+            catch(const std::out_of_range &){
+                std::cerr << "Value " << args[i] << " for " << arg << " is out of range\n";
+                print_usage(prog);
+                return false;
+            }
+            opts.runArgs.insert(opts.runArgs.end(), args.begin() + first, args.begin() + i + 1);
+        }
+        return true;
+    }
+
+    // "auto" takes the index of the array job the shard runs in
+    bool shard_index(const std::string &value, size_t &shard){
+        std::string index = value;
+        if(value == "auto"){
+            index.clear();
+            for(const char *var: {"DIMER_SHARD", "SLURM_ARRAY_TASK_ID", "PBS_ARRAY_INDEX"}){
+                if(const char *env = std::getenv(var)){
+                    index = env;
+                    break;
+                }
+            }
+        }
+        try{
+            size_t used;
+            shard = std::stoul(index, &used);
+            return used == index.size();
+        }
+        catch(const std::exception &){
+            return false;
+        }
+    }
+
+    int merge(const ShardManifest &manifest, const std::string &output){
+        MergeResult result;
+        std::string error;
+        if(!merge_shards(manifest, output, result, error)){
+            std::cerr << error << "\n";
+            for(auto k: result.missing){
+                std::cerr << "  shard " << k << " is not complete, run it with --shard " << k << "\n";
+            }
+            return 1;
+        }
+        std::cerr << result.written << " products merged into " << output << ", "
+                  << result.duplicates << " made by more than one shard dropped\n";
+        return 0;
+    }
+
+    // Runs the incomplete shards as child processes of this executable, then merges.
+    // Every child runs on threads threads, by default an equal share of the cores.
+    int run_local(const ShardManifest &manifest, const std::string &manifestPath, size_t jobs, unsigned int threads, const char *prog){
+        if(!threads){
+            threads = std::max<unsigned int>(1, std::thread::hardware_concurrency() / jobs);
+        }
+        std::string threadArg = std::to_string(threads);
+        std::vector<size_t> pending, failed;
+        for(size_t k = manifest.shards.size(); k -- > 0;){
+            if(!manifest.shard_done(k)){
+                pending.push_back(k);
+            }
+        }
+
+        std::map<pid_t, size_t> running;
+        while(!pending.empty() || !running.empty()){
+            while(running.size() < jobs && !pending.empty()){
+                size_t k = pending.back();
+                pending.pop_back();
+                std::string index = std::to_string(k);
+                pid_t pid = fork();
+                if(pid == 0){
+                    execl("/proc/self/exe", prog, "--manifest", manifestPath.c_str(), "--shard", index.c_str(),
+                          "--threads", threadArg.c_str(), (char*)nullptr);
+                    _exit(127);
+                }
+                if(pid < 0){
+                    failed.push_back(k);
+                    continue;
+                }
+                running[pid] = k;
+            }
+            if(running.empty()){
+                break;
+            }
+
+            int status;
+            pid_t pid = waitpid(-1, &status, 0);
+            if(pid < 0){
+                break;
+            }
+            auto it = running.find(pid);
+            if(it == running.end()){
+                continue;
+            }
+            if(!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !manifest.shard_done(it->second)){
+                failed.push_back(it->second);
+            }
+            running.erase(it);
+        }
+
+        if(!failed.empty()){
+            std::sort(failed.begin(), failed.end());
+            std::cerr << failed.size() << " shards failed:";
+            for(auto k: failed){
+                std::cerr << " " << k;
+            }
+            std::cerr << "\nRunning the same command again retries only those\n";
+            return 1;
+        }
+        return merge(manifest, manifest.output);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+    Options opts;
+    int exitCode;
+    if(!parse_args(args, opts, argv[0], exitCode)){
+        return exitCode;
+    }
+
+    // A shard runs the planned options on its range of cells, its own command line may add -s or -p
+    ShardManifest manifest;
+    bool sharded = false;
+    size_t shard = 0;
+    if(!opts.manifest.empty() && !opts.shards){
+        std::string error;
+        if(!manifest.read(opts.manifest, error)){
+            std::cerr << error << "\n";
+            return 1;
+        }
+        if(opts.merge){
+            return merge(manifest, opts.output.empty() ? manifest.output : opts.output);
+        }
+        if(opts.localJobs){
+            return run_local(manifest, opts.manifest, opts.localJobs, opts.threads, argv[0]);
+        }
+        if(!shard_index(opts.shard, shard) || shard >= manifest.shards.size()){
+            std::cerr << "Need --shard with one of the " << manifest.shards.size() << " shards of " << opts.manifest
+                      << ", or --local or --merge\n";
+            return 1;
+        }
+        args.insert(args.begin(), manifest.args.begin(), manifest.args.end());
+        unsigned int threads = opts.threads;
+        opts = Options();
+        opts.threads = threads;
+        if(!parse_args(args, opts, argv[0], exitCode)){
+            return exitCode;
+        }
+        opts.output = manifest.partial_path(shard);
+        sharded = true;
+    }
+
+    std::vector<InputMolecule> templates;
+    for(const auto &path: opts.bridges){
+        read_inputs(path, templates);
+    }
+    BridgeKeyCache bridgeKeys;
+    std::unordered_map<std::string, RXN_SPTR> bridgeReactions;
+    for(const auto &t: templates){
+        for(const auto &p: generate_bridges(t.mol, &bridgeKeys, opts.threads)){
+            bridgeReactions.insert(p);
+        }
+    }
+    size_t firstBridge = opts.reactions.size();
+    for(const auto &p: bridgeReactions){
+        opts.reactions.add("", p.second);
+    }
+    std::vector<RXN_SPTR> reactions;
+    std::vector<std::string> reactionNames;
+    for(const auto &r: opts.reactions.reactions()){
+        reactions.push_back(r.rxn);
+        reactionNames.push_back(r.name);
+    }
+
+    if(!opts.saveLibrary.empty()){
+        std::string error;
+        if(!opts.reactions.save(opts.saveLibrary, error)){
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::cerr << opts.reactions.size() << " reactions saved to " << opts.saveLibrary << ", "
+                  << opts.reactions.duplicates() << " duplicates dropped\n";
+        if(opts.inputs.empty()){
+            return 0;
+        }
+    }
+
+    std::vector<InputMolecule> mols;
+    for(const auto &path: opts.inputs){
+        read_inputs(path, mols);
+    }
+
+    if(reactions.empty() || mols.empty()){
+        std::cerr << "Nothing to do: need at least one reaction and one molecule\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Cells are reaction-major, a cell is a monomer or a group of cross pairs
+    size_t numTasks = opts.crossPairs ? cross_pair_tasks(mols.size()) : mols.size();
+    size_t cells = reactions.size() * numTasks;
+    if(opts.shards){
+        if(opts.manifest.empty() || opts.output.empty() || opts.output == "-"){
+            std::cerr << "A sharded run needs --manifest and -o for the merged output\n";
+            return 1;
+        }
+        manifest.output = std::filesystem::absolute(opts.output).string();
+        manifest.args = opts.runArgs;
+        for(size_t i = firstBridge; i < reactions.size(); i ++){
+            manifest.args.push_back("-r");
+            manifest.args.push_back(reactionNames[i]);
+        }
+        manifest.reactions = reactions.size();
+        manifest.molecules = mols.size();
+        manifest.cells = cells;
+        manifest.shards = split_cells(cells, opts.shards);
+        std::string error;
+        if(!manifest.write(opts.manifest, error)){
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::cerr << cells << " cells split into " << manifest.shards.size() << " shards in " << opts.manifest << "\n";
+        return 0;
+    }
+
+    ShardRange range{0, cells};
+    if(sharded){
+        if(manifest.reactions != reactions.size() || manifest.molecules != mols.size() || manifest.cells != cells){
+            std::cerr << "The reactions or molecules of " << opts.manifest << " changed since it was planned\n";
+            return 1;
+        }
+        range = manifest.shards[shard];
+    }
+
+    // Products are streamed to the output by a background writer as they are found
+    ProductWriter writer(opts.output);
+    if(!writer.ok()){
+        std::cerr << writer.error() << "\n";
+        return 1;
+    }
+
+    RunStats stats(reactions.size(), mols.size());
+    RunStats::Scope scope(&stats);
+
+    // Only the monomers of the cells in range are prepared
+    std::vector<char> needed(mols.size(), 0);
+    for(size_t c = range.begin; c < range.end; c ++){
+        if(opts.crossPairs){
+            for_each_cross_pair(mols.size(), c % numTasks, [&needed](size_t a, size_t b){
+                needed[a] = needed[b] = 1;
+            });
+        }
+        else{
+            needed[c % numTasks] = 1;
+        }
+    }
+    std::vector<PREPARED_SPTR> prepared(mols.size());
+    parallel_for(mols.size(), [&](size_t j){
+        if(needed[j]){
+            RunStats::Scope prepareScope(&stats);
+            prepared[j] = prepare_reactant(mols[j].mol);
+        }
+    }, opts.threads);
+
+    std::unique_ptr<ResultCache> cache;
+    std::vector<std::string> reactionKeys(reactions.size());
+    if(!opts.cacheDir.empty()){
+        cache.reset(new ResultCache(opts.cacheDir));
+        for(unsigned int i = 0; i < reactions.size(); i ++){
+            reactionKeys[i] = ResultCache::reaction_key(*reactions[i]);
+        }
+    }
+
+    // The same dimer made by another reaction or from another file is written only once
+    ProductRegistry registry;
+    if(opts.crossPairs){
+        std::vector<char> symmetric(reactions.size());
+        for(unsigned int i = 0; i < reactions.size(); i ++){
+            symmetric[i] = symmetric_reaction(reactions[i]);
+        }
+        // Pair groups run in parallel, the registry and the writer are shared by them
+        parallel_for(range.end - range.begin, [&](size_t c){
+            RunStats::Scope taskScope(&stats);
+            unsigned int i = (range.begin + c) / numTasks;
+            for_each_cross_pair(mols.size(), (range.begin + c) % numTasks, [&](size_t a, size_t b){
+                auto start = std::chrono::steady_clock::now();
+                size_t generated = 0, kept = 0;
+                try{
+                    for(const auto &p: run_cross_pair(reactions[i], *prepared[a], *prepared[b], symmetric[i], &opts.filter)){
+                        generated ++;
+                        bool added;
+                        {
+                            StageTimer timer(Stage::Dedupe);
+                            added = registry.insert(p.first, i, a, b);
+                        }
+                        if(added){
+                            kept ++;
+                            writer.write({p.first, p.second, reactionNames[i], a == b ? mols[a].name : mols[a].name + " + " + mols[b].name});
+                        }
+                    }
+                }
+                catch(const std::exception &e){
+                    report_failure(stats, reactionNames[i], a == b ? mols[a].name : mols[a].name + " + " + mols[b].name, e);
+                }
+                auto elapsed = (std::chrono::steady_clock::now() - start) / 2;
+                stats.add_cell(i, a, elapsed, generated, kept);
+                stats.add_cell(i, b, elapsed, 0, 0);
+            });
+        }, opts.threads);
+    }
+    else{
+        // Cells run in parallel like pair groups do, so oligomers grow on one thread each
+        OligomerOptions oligomers = opts.oligomers;
+        oligomers.threads = 1;
+        parallel_for(range.end - range.begin, [&](size_t c){
+            RunStats::Scope taskScope(&stats);
+            unsigned int i = (range.begin + c) / numTasks, j = (range.begin + c) % numTasks;
+            auto start = std::chrono::steady_clock::now();
+            size_t generated = 0, kept = 0;
+            try{
+                for(const auto &p: run_reaction_cached(reactions[i], reactionKeys[i], *prepared[j], cache.get(), &opts.filter, &oligomers)){
+                    generated ++;
+                    bool added;
+                    {
+                        StageTimer timer(Stage::Dedupe);
+                        added = registry.insert(p.first, i, j);
+                    }
+                    if(added){
+                        kept ++;
+                        writer.write({p.first, p.second, reactionNames[i], mols[j].name});
+                    }
+                }
+            }
+            catch(const std::exception &e){
+                report_failure(stats, reactionNames[i], mols[j].name, e);
+            }
+            stats.add_cell(i, j, std::chrono::steady_clock::now() - start, generated, kept);
+        }, opts.threads);
+    }
+
+    if(!writer.close()){
+        std::cerr << writer.error() << "\n";
+        return 1;
+    }
+    if(writer.skipped()){
+        std::cerr << writer.skipped() << " products could not be written, the first because of " << writer.skip_reason() << "\n";
+    }
+    // A shard with failed cells is left incomplete, so the merge does not miss their products silently
+    if(sharded && !stats.failed()){
+        // Only a complete shard file gets the name that marks the shard done
+        std::error_code ec;
+        std::filesystem::rename(opts.output, manifest.shard_path(shard), ec);
+        if(ec){
+            std::cerr << "Cannot rename " << opts.output << ": " << ec.message() << "\n";
+            return 1;
+        }
+    }
+    stats.finish();
+
+    if(!opts.report.empty()){
+        std::vector<std::string> molNames;
+        for(const auto &m: mols){
+            molNames.push_back(m.name);
+        }
+        std::ofstream rep(opts.report);
+        if(!rep){
+            std::cerr << "Cannot open " << opts.report << " for writing\n";
+            return 1;
+        }
+        stats.write_json(rep, reactionNames, molNames);
+    }
+
+    if(!opts.provenance.empty()){
+        std::ofstream prov(opts.provenance);
+        if(!prov){
+            std::cerr << "Cannot open " << opts.provenance << " for writing\n";
+            return 1;
+        }
+        registry.for_each([&](const std::string &key, const std::vector<Provenance> &producers){
+            for(const auto &p: producers){
+                prov << key << "\t" << mols[p.molecule].name;
+                if(p.partner != p.molecule){
+                    prov << " + " << mols[p.partner].name;
+                }
+                prov << "\t" << reactionNames[p.reaction] << "\n";
+            }
+        });
+    }
+    std::cerr << registry.size() << " products, " << registry.duplicates() << " duplicates dropped"
+              << " in " << stats.wall_seconds() << " s (" << stats.summary() << ")\n";
+    if(stats.rejected()){
+        std::cerr << stats.rejected() << " raw products rejected (" << stats.rejection_summary() << ")\n";
+    }
+    if(cache){
+        std::cerr << cache->hits() << " of " << cache->hits() + cache->misses() << " cells read from the cache\n";
+    }
+    if(stats.failed()){
+        std::cerr << stats.failed() << " cells failed, their products are missing\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#include "depiction.h"
+#include "instrumentation.h"
+
+#include <GraphMol/FileParsers/MolFileStereochem.h>
+#include <GraphMol/Depictor/RDDepictor.h>
+
+RDKit::ROMOL_SPTR prepare_depiction(const RDKit::ROMol &mol){
+    StageTimer timer(Stage::Depiction);
+    boost::shared_ptr<RDKit::RWMol> res(new RDKit::RWMol(mol));
+    RDKit::MolOps::Kekulize(*res);
+    RDDepict::compute2DCoords(*res);
+    if (!res->hasProp("_drawingBondsWedged")) {
+        RDKit::Conformer conf = res->getConformer();
+        RDKit::WedgeMolBonds(*res, &conf);
+    }
+    return res;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <GraphMol/GraphMol.h>
+
+// Kekulized copy of the molecule with 2D coordinates and wedged bonds, ready for MolDraw2D
+RDKit::ROMOL_SPTR prepare_depiction(const RDKit::ROMol &mol);
@@ -0,0 +1,311 @@
+#include "gridrunner.h"
+
+#include <QDebug>
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+#include "parallel.h"
+
+struct GridRunner::RunState {
+    // Each monomer is prepared by the first cell that needs it and then shared by all reactions
+    struct PreparedSlot {
+        std::once_flag once;
+        PREPARED_SPTR prepared;
+    };
+
+    explicit RunState(size_t molecules) : prepared(molecules) {}
+
+    PREPARED_SPTR prepare(int molecule, const RDKit::ROMOL_SPTR &mol){
+        PreparedSlot &slot = prepared[molecule];
+        std::call_once(slot.once, [&slot, &mol](){
+            slot.prepared = prepare_reactant(mol);
+        });
+        return slot.prepared;
+    }
+
+    std::vector<PreparedSlot> prepared;
+    std::atomic<bool> cancelled{false};
+    bool paused = false;
+    QMutex mutex;
+    QWaitCondition resumed;
+
+    void wait_while_paused(){
+        QMutexLocker lock(&mutex);
+        while(paused && !cancelled){
+            resumed.wait(&mutex);
+        }
+    }
+};
+
+namespace {
+    class CellTask : public QRunnable
+    {
+    public:
+        explicit CellTask(std::function<void()> fn) : m_fn(std::move(fn)) {}
+        void run() override { m_fn(); }
+    private:
+        std::function<void()> m_fn;
+    };
+}
+
+GridRunner::GridRunner(QObject *parent)
+    : QObject{parent},
+      m_done(0),
+      m_total(0),
+      m_pausedMs(0)
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+GridRunner::~GridRunner(){
+    blockSignals(true);
+    cancel();
+    m_pool.waitForDone();
+}
+
+void GridRunner::start(const std::vector<RXN_SPTR> &reactions, const std::vector<RDKit::ROMOL_SPTR> &molecules){
+    cancel();
+
+    m_state = std::make_shared<RunState>(molecules.size());
+    m_registry = std::make_shared<ProductRegistry>();
+    m_store = std::make_shared<ProductStore>();
+    m_stats = std::make_shared<RunStats>(reactions.size(), molecules.size());
+    m_done = 0;
+    m_total = int(reactions.size() * (m_crossPairs ? cross_pair_tasks(molecules.size()) : molecules.size()));
+    m_pausedMs = 0;
+    m_timer.start();
+
+    if(!m_total){
+        m_state.reset();
+        m_stats->finish();
+        emit finished(false);
+        return;
+    }
+
+    if(m_crossPairs){
+        start_cross_pairs(reactions, molecules);
+        return;
+    }
+
+    auto state = m_state;
+    auto registry = m_registry;
+    auto store = m_store;
+    auto cache = m_cache;
+    auto stats = m_stats;
+    auto filter = m_filter;
+    auto oligomers = m_oligomers;
+    std::vector<std::string> reactionKeys;
+    for(const auto &rxn: reactions){
+        reactionKeys.push_back(cache ? ResultCache::reaction_key(*rxn) : "");
+    }
+    for(int i = 0; i < int(reactions.size()); i ++){
+        for(int j = 0; j < int(molecules.size()); j ++){
+            RXN_SPTR rxn = reactions[i];
+            RDKit::ROMOL_SPTR mol = molecules[j];
+            std::string reactionKey = reactionKeys[i];
+            m_pool.start(new CellTask([this, state, registry, store, cache, stats, filter, oligomers, rxn, reactionKey, mol, i, j](){
+                state->wait_while_paused();
+                if(state->cancelled){
+                    return;
+                }
+
+                RunStats::Scope scope(stats.get());
+                auto start = std::chrono::steady_clock::now();
+                size_t generated = 0;
+                std::vector<MoleculeRecord> records;
+                try{
+                    for(auto &p: run_reaction_cached(rxn, reactionKey, *state->prepare(j, mol), cache.get(), &filter, &oligomers)){
+                        generated ++;
+                        // Products already made by another cell are dropped before they reach the view
+                        bool kept;
+                        {
+                            StageTimer timer(Stage::Dedupe);
+                            kept = registry->insert(p.first, i, j);
+                        }
+                        if(kept){
+                            // Only the pickle outlives the cell, the live product is dropped with the cell's results
+                            records.push_back({"", nullptr, store->append(p.first, *p.second)});
+                        }
+                    }
+                }
+                catch(const std::exception &e){
+                    qWarning() << "Reaction" << i << "failed on molecule" << j << ":" << e.what();
+                    stats->add_failure();
+                }
+                stats->add_cell(i, j, std::chrono::steady_clock::now() - start, generated, records.size());
+
+                QMetaObject::invokeMethod(this, [this, state, i, j, records = std::move(records)](){
+                    cell_done(state, i, j, records);
+                }, Qt::QueuedConnection);
+            }));
+        }
+    }
+}
+
+void GridRunner::start_cross_pairs(const std::vector<RXN_SPTR> &reactions, const std::vector<RDKit::ROMOL_SPTR> &molecules){
+    auto state = m_state;
+    auto registry = m_registry;
+    auto store = m_store;
+    auto stats = m_stats;
+    auto filter = m_filter;
+    auto shared = std::make_shared<const std::vector<RDKit::ROMOL_SPTR>>(molecules);
+    size_t n = molecules.size();
+    for(int i = 0; i < int(reactions.size()); i ++){
+        RXN_SPTR rxn = reactions[i];
+        bool symmetric = symmetric_reaction(rxn);
+        // A task is two rows of the upper triangle of the pair matrix, about n pairs
+        for(int t = 0; t < int(cross_pair_tasks(n)); t ++){
+            m_pool.start(new CellTask([this, state, registry, store, stats, filter, shared, rxn, symmetric, n, i, t](){
+                RunStats::Scope scope(stats.get());
+                std::vector<MoleculeRecord> records;
+                for_each_cross_pair(n, t, [&](size_t a, size_t b){
+                    state->wait_while_paused();
+                    if(state->cancelled){
+                        return;
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    size_t generated = 0, kept = 0;
+                    try{
+                        PREPARED_SPTR pa = state->prepare(a, (*shared)[a]);
+                        PREPARED_SPTR pb = state->prepare(b, (*shared)[b]);
+                        for(auto &p: run_cross_pair(rxn, *pa, *pb, symmetric, &filter)){
+                            generated ++;
+                            bool added;
+                            {
+                                StageTimer timer(Stage::Dedupe);
+                                added = registry->insert(p.first, i, a, b);
+                            }
+                            if(added){
+                                kept ++;
+                                records.push_back({"", nullptr, store->append(p.first, *p.second)});
+                            }
+                        }
+                    }
+                    catch(const std::exception &e){
+                        qWarning() << "Reaction" << i << "failed on molecules" << a << "and" << b << ":" << e.what();
+                        stats->add_failure();
+                    }
+                    // The time of a pair is shared between both monomers
+                    auto elapsed = (std::chrono::steady_clock::now() - start) / 2;
+                    stats->add_cell(i, a, elapsed, generated, kept);
+                    stats->add_cell(i, b, elapsed, 0, 0);
+                });
+                if(state->cancelled){
+                    return;
+                }
+
+                QMetaObject::invokeMethod(this, [this, state, i, t, records = std::move(records)](){
+                    cell_done(state, i, t, records);
+                }, Qt::QueuedConnection);
+            }));
+        }
+    }
+}
+
+void GridRunner::cell_done(const std::shared_ptr<RunState> &state, int reaction, int molecule, const std::vector<MoleculeRecord> &products){
+    if(state != m_state || state->cancelled){
+        return; // Result of a cancelled run
+    }
+
+    m_done ++;
+    emit products_ready(reaction, molecule, products);
+
+    qint64 elapsed = active_time();
+    emit progress(m_done, m_total, elapsed * (m_total - m_done) / m_done);
+
+    if(m_done == m_total){
+        m_state.reset();
+        m_stats->finish();
+        emit finished(false);
+    }
+}
+
+void GridRunner::pause(){
+    if(!m_state || is_paused()){
+        return;
+    }
+    QMutexLocker lock(&m_state->mutex);
+    m_state->paused = true;
+    m_pauseTimer.start();
+}
+
+void GridRunner::resume(){
+    if(!m_state || !is_paused()){
+        return;
+    }
+    QMutexLocker lock(&m_state->mutex);
+    m_state->paused = false;
+    m_pausedMs += m_pauseTimer.elapsed();
+    m_state->resumed.wakeAll();
+}
+
+void GridRunner::cancel(){
+    if(!m_state){
+        return;
+    }
+    {
+        QMutexLocker lock(&m_state->mutex);
+        m_state->cancelled = true;
+        m_state->resumed.wakeAll();
+    }
+    m_pool.clear();
+    m_state.reset();
+    m_stats->finish();
+    emit finished(true);
+}
+
+void GridRunner::set_cache(std::shared_ptr<const ResultCache> cache){
+    m_cache = std::move(cache);
+}
+
+void GridRunner::set_filter(const ProductFilter &filter){
+    m_filter = filter;
+}
+
+void GridRunner::set_cross_pairs(bool cross){
+    m_crossPairs = cross;
+}
+
+void GridRunner::set_oligomers(const OligomerOptions &oligomers){
+    m_oligomers = oligomers;
+    m_oligomers.threads = 1; // Cells already keep every core busy
+}
+
+std::shared_ptr<const ProductRegistry> GridRunner::registry() const{
+    return m_registry;
+}
+
+std::shared_ptr<const ProductStore> GridRunner::store() const{
+    return m_store;
+}
+
+std::shared_ptr<RunStats> GridRunner::stats() const{
+    return m_stats;
+}
+
+bool GridRunner::is_running() const{
+    return bool(m_state);
+}
+
+bool GridRunner::is_paused() const{
+    if(!m_state){
+        return false;
+    }
+    QMutexLocker lock(&m_state->mutex);
+    return m_state->paused;
+}
+
+qint64 GridRunner::active_time() const{
+    qint64 paused = m_pausedMs;
+    if(is_paused()){
+        paused += m_pauseTimer.elapsed();
+    }
+    return m_timer.elapsed() - paused;
+}
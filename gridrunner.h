@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QElapsedTimer>
+
+#include <memory>
+#include <vector>
+
+#include "moleculemodel.h"
+#include "productregistry.h"
+#include "reactionengine.h"
+#include "resultcache.h"
+#include "instrumentation.h"
+#include "productstore.h"
+
+// Runs every reaction on every molecule as independent cells on a thread pool.
+// Results are delivered on the thread that owns the runner, one cell at a time.
+// In cross-pair mode every reaction joins every unordered pair of molecules
+// instead, and a cell is a balanced group of about as many pairs as molecules.
+class GridRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GridRunner(QObject *parent = nullptr);
+    ~GridRunner();
+
+    void start(const std::vector<RXN_SPTR> &reactions, const std::vector<RDKit::ROMOL_SPTR> &molecules);
+
+    // Cells found in the cache are read back instead of computed, null disables it
+    void set_cache(std::shared_ptr<const ResultCache> cache);
+    // Limits raw products have to respect, applies from the next start()
+    void set_filter(const ProductFilter &filter);
+    // Cross dimers of every pair of molecules instead of homodimers, applies from the next start()
+    void set_cross_pairs(bool cross);
+    // Oligomer growth beyond dimers, applies from the next start(); ignored for cross pairs
+    void set_oligomers(const OligomerOptions &oligomers);
+    void pause();
+    void resume();
+    void cancel();
+
+    // Every product of the current or last run with the cells that produced it
+    std::shared_ptr<const ProductRegistry> registry() const;
+
+    // Products kept by the current or last run, as pickles; records of products_ready index into it
+    std::shared_ptr<const ProductStore> store() const;
+
+    // Stage timings and counters of the current or last run
+    std::shared_ptr<RunStats> stats() const;
+
+    bool is_running() const;
+    bool is_paused() const;
+
+signals:
+    // molecule is the index of the pair group in cross-pair mode
+    void products_ready(int reaction, int molecule, const std::vector<MoleculeRecord> &products);
+    void progress(int done, int total, qint64 eta_ms);
+    void finished(bool cancelled);
+
+private:
+    struct RunState;
+
+    void start_cross_pairs(const std::vector<RXN_SPTR> &reactions, const std::vector<RDKit::ROMOL_SPTR> &molecules);
+    void cell_done(const std::shared_ptr<RunState> &state, int reaction, int molecule, const std::vector<MoleculeRecord> &products);
+    qint64 active_time() const;
+
+    QThreadPool m_pool;
+    std::shared_ptr<RunState> m_state;
+    std::shared_ptr<ProductRegistry> m_registry;
+    std::shared_ptr<ProductStore> m_store;
+    std::shared_ptr<const ResultCache> m_cache;
+    ProductFilter m_filter;
+    OligomerOptions m_oligomers;
+    bool m_crossPairs = false;
+    std::shared_ptr<RunStats> m_stats;
+    int m_done, m_total;
+    QElapsedTimer m_timer, m_pauseTimer;
+    qint64 m_pausedMs;
+};
@@ -0,0 +1,98 @@
+#include "inputloader.h"
+
+#include <QRunnable>
+
+#include <atomic>
+#include <functional>
+
+struct InputLoader::LoadState {
+    std::atomic<bool> cancelled{false};
+};
+
+namespace {
+    class LoadTask : public QRunnable
+    {
+    public:
+        explicit LoadTask(std::function<void()> fn) : m_fn(std::move(fn)) {}
+        void run() override { m_fn(); }
+    private:
+        std::function<void()> m_fn;
+    };
+}
+
+InputLoader::InputLoader(QObject *parent)
+    : QObject{parent}
+{
+    // Files are read one after the other, each batch is already parsed on all cores
+    m_pool.setMaxThreadCount(1);
+}
+
+InputLoader::~InputLoader(){
+    blockSignals(true);
+    cancel();
+    m_pool.waitForDone();
+}
+
+void InputLoader::start(const QStringList &paths){
+    cancel();
+
+    m_state = std::make_shared<LoadState>();
+    m_errors.clear();
+
+    std::vector<std::string> files;
+    for(const auto &p: paths){
+        files.push_back(p.toStdString());
+    }
+
+    auto state = m_state;
+    m_pool.start(new LoadTask([this, state, files](){
+        for(const auto &file: files){
+            bool more = read_molecules(file, [this, state](ReadBatch &batch){
+                if(state->cancelled){
+                    return false;
+                }
+                QMetaObject::invokeMethod(this, [this, state, batch = std::move(batch)]() mutable {
+                    batch_done(state, batch);
+                }, Qt::QueuedConnection);
+                return true;
+            });
+            if(!more){
+                break;
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, state](){
+            load_done(state);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void InputLoader::batch_done(const std::shared_ptr<LoadState> &state, ReadBatch &batch){
+    if(state != m_state || state->cancelled){
+        return; // Batch of a cancelled load
+    }
+    m_errors.insert(m_errors.end(), batch.errors.begin(), batch.errors.end());
+    if(!batch.molecules.empty()){
+        emit molecules_ready(batch.molecules);
+    }
+}
+
+void InputLoader::load_done(const std::shared_ptr<LoadState> &state){
+    if(state != m_state || state->cancelled){
+        return;
+    }
+    m_state.reset();
+    emit finished(m_errors, false);
+}
+
+void InputLoader::cancel(){
+    if(!m_state){
+        return;
+    }
+    m_state->cancelled = true;
+    m_state.reset();
+    emit finished(m_errors, true);
+}
+
+bool InputLoader::is_running() const{
+    return bool(m_state);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <memory>
+#include <vector>
+
+#include "moleculereader.h"
+
+// Reads monomer files on a background thread and delivers the molecules batch
+// by batch on the thread that owns the loader, so a table can fill while the
+// rest of the library is still being parsed.
+class InputLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InputLoader(QObject *parent = nullptr);
+    ~InputLoader();
+
+    void start(const QStringList &paths);
+    void cancel();
+
+    bool is_running() const;
+
+signals:
+    void molecules_ready(const std::vector<InputMolecule> &molecules);
+    void finished(const std::vector<ReadError> &errors, bool cancelled);
+
+private:
+    struct LoadState;
+
+    void batch_done(const std::shared_ptr<LoadState> &state, ReadBatch &batch);
+    void load_done(const std::shared_ptr<LoadState> &state);
+
+    QThreadPool m_pool;
+    std::shared_ptr<LoadState> m_state;
+    std::vector<ReadError> m_errors;
+};
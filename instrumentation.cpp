@@ -0,0 +1,212 @@
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+namespace {
+    thread_local RunStats *current_stats = nullptr;
+
+    double to_seconds(int64_t ns){
+        return ns * 1e-9;
+    }
+
+    std::string json_string(const std::string &s){
+        std::string res = "\"";
+        for(char c: s){
+            if(c == '"' || c == '\\'){
+                res += '\\';
+            }
+            if((unsigned char)c < 0x20){
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                res += buf;
+                continue;
+            }
+            res += c;
+        }
+        return res + "\"";
+    }
+
+    // Entries of a per-item cost table, costliest first
+    void write_costs(std::ostream &out, const std::atomic<int64_t> *ns, size_t count, const std::vector<std::string> &names){
+        std::vector<size_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [ns](size_t a, size_t b){
+            return ns[a] > ns[b];
+        });
+        out << "[";
+        for(size_t i = 0; i < order.size(); i ++){
+            size_t idx = order[i];
+            out << (i ? "," : "") << "\n    {\"index\": " << idx
+                << ", \"name\": " << json_string(idx < names.size() ? names[idx] : "")
+                << ", \"seconds\": " << to_seconds(ns[idx]) << "}";
+        }
+        out << "\n  ]";
+    }
+}
+
+const char *stage_name(Stage stage){
+    switch(stage){
+    case Stage::Prepare: return "prepare";
+    case Stage::Match: return "match";
+    case Stage::RunReactants: return "runReactants";
+    case Stage::Sanitize: return "sanitize";
+    case Stage::Canonicalize: return "canonicalize";
+    case Stage::Dedupe: return "dedupe";
+    case Stage::Depiction: return "depiction";
+    case Stage::Display: return "display";
+    case Stage::Count: break;
+    }
+    return "";
+}
+
+const char *rejection_name(Rejection rejection){
+    switch(rejection){
+    case Rejection::HeavyAtoms: return "heavyAtoms";
+    case Rejection::Rings: return "rings";
+    case Rejection::Sanitize: return "sanitize";
+    case Rejection::MolWt: return "molWt";
+    case Rejection::Count: break;
+    }
+    return "";
+}
+
+RunStats::RunStats(size_t reactions, size_t molecules)
+    : m_reactionNs(new std::atomic<int64_t>[reactions]()),
+      m_moleculeNs(new std::atomic<int64_t>[molecules]()),
+      m_reactions(reactions),
+      m_molecules(molecules),
+      m_start(std::chrono::steady_clock::now()),
+      m_finished(false)
+{
+}
+
+void RunStats::add(Stage stage, std::chrono::nanoseconds elapsed){
+    Counter &c = m_stages[size_t(stage)];
+    c.ns += elapsed.count();
+    c.calls ++;
+}
+
+void RunStats::add_cell(size_t reaction, size_t molecule, std::chrono::nanoseconds elapsed, size_t generated, size_t kept){
+    if(reaction < m_reactions){
+        m_reactionNs[reaction] += elapsed.count();
+    }
+    if(molecule < m_molecules){
+        m_moleculeNs[molecule] += elapsed.count();
+    }
+    m_generated += generated;
+    m_kept += kept;
+}
+
+void RunStats::add_rejection(Rejection rejection){
+    m_rejected[size_t(rejection)] ++;
+}
+
+void RunStats::add_failure(){
+    m_failed ++;
+}
+
+void RunStats::reject(Rejection rejection){
+    if(current_stats){
+        current_stats->add_rejection(rejection);
+    }
+}
+
+size_t RunStats::rejected(Rejection rejection) const{
+    return m_rejected[size_t(rejection)];
+}
+
+size_t RunStats::rejected() const{
+    size_t res = 0;
+    for(const auto &r: m_rejected){
+        res += r;
+    }
+    return res;
+}
+
+double RunStats::seconds(Stage stage) const{
+    return to_seconds(m_stages[size_t(stage)].ns);
+}
+
+size_t RunStats::calls(Stage stage) const{
+    return m_stages[size_t(stage)].calls;
+}
+
+double RunStats::wall_seconds() const{
+    auto end = m_finished ? m_end : std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - m_start).count();
+}
+
+void RunStats::finish(){
+    m_end = std::chrono::steady_clock::now();
+    m_finished = true;
+}
+
+std::string RunStats::summary(size_t stages) const{
+    std::vector<Stage> order;
+    for(size_t i = 0; i < size_t(Stage::Count); i ++){
+        if(calls(Stage(i))){
+            order.push_back(Stage(i));
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](Stage a, Stage b){
+        return seconds(a) > seconds(b);
+    });
+
+    std::string res;
+    for(size_t i = 0; i < order.size() && i < stages; i ++){
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%s%s %.1f s", i ? ", " : "", stage_name(order[i]), seconds(order[i]));
+        res += buf;
+    }
+    return res;
+}
+
+std::string RunStats::rejection_summary() const{
+    std::string res;
+    for(size_t i = 0; i < size_t(Rejection::Count); i ++){
+        if(m_rejected[i]){
+            res += (res.empty() ? "" : ", ") + std::string(rejection_name(Rejection(i))) + " " + std::to_string(m_rejected[i]);
+        }
+    }
+    return res;
+}
+
+void RunStats::write_json(std::ostream &out, const std::vector<std::string> &reactionNames, const std::vector<std::string> &moleculeNames) const{
+    // Stage times are summed over threads, so they can add up to more than the wall time
+    out << "{\n"
+        << "  \"wall_seconds\": " << wall_seconds() << ",\n"
+        << "  \"products\": {\"generated\": " << generated() << ", \"kept\": " << kept() << "},\n"
+        << "  \"failed_cells\": " << failed() << ",\n"
+        << "  \"rejected\": {";
+    for(size_t i = 0; i < size_t(Rejection::Count); i ++){
+        out << (i ? ", " : "") << json_string(rejection_name(Rejection(i))) << ": " << rejected(Rejection(i));
+    }
+    out << "},\n"
+        << "  \"stages\": [";
+    for(size_t i = 0; i < size_t(Stage::Count); i ++){
+        out << (i ? "," : "") << "\n    {\"name\": " << json_string(stage_name(Stage(i)))
+            << ", \"calls\": " << calls(Stage(i))
+            << ", \"seconds\": " << seconds(Stage(i)) << "}";
+    }
+    out << "\n  ],\n  \"molecules\": ";
+    write_costs(out, m_moleculeNs.get(), m_molecules, moleculeNames);
+    out << ",\n  \"reactions\": ";
+    write_costs(out, m_reactionNs.get(), m_reactions, reactionNames);
+    out << "\n}\n";
+}
+
+RunStats::Scope::Scope(RunStats *stats)
+    : m_previous(current_stats)
+{
+    current_stats = stats;
+}
+
+RunStats::Scope::~Scope(){
+    current_stats = m_previous;
+}
+
+RunStats *RunStats::current(){
+    return current_stats;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Low overhead per-stage timers and counters of a run. A thread opts in for a
+// while with RunStats::Scope; engine code then times its stages with
+// StageTimer, which costs one thread-local load when no run is being measured.
+
+enum class Stage {
+    Prepare,       // prepare_reactant
+    Match,         // Reactant template matching in reactive_sites
+    RunReactants,  // ChemicalReaction::runReactants, substructure matching included
+    Sanitize,      // Sanitization of raw products
+    Canonicalize,  // Canonical SMILES of products
+    Dedupe,        // Product map and registry insertion
+    Depiction,     // compute2DCoords and bond wedging
+    Display,       // Handing products to the views
+    Count
+};
+
+// Why the filter stage dropped a raw product, in the order the checks run
+enum class Rejection {
+    HeavyAtoms,
+    Rings,
+    Sanitize,
+    MolWt,
+    Count
+};
+
+const char *stage_name(Stage stage);
+const char *rejection_name(Rejection rejection);
+
+class RunStats
+{
+public:
+    RunStats(size_t reactions, size_t molecules);
+
+    void add(Stage stage, std::chrono::nanoseconds elapsed);
+    void add_cell(size_t reaction, size_t molecule, std::chrono::nanoseconds elapsed, size_t generated, size_t kept);
+    void add_rejection(Rejection rejection);
+    // A cell whose reaction threw, its products are lost
+    void add_failure();
+
+    // Counts a rejection on the stats of this thread, if any
+    static void reject(Rejection rejection);
+
+    double seconds(Stage stage) const;
+    size_t calls(Stage stage) const;
+    size_t generated() const { return m_generated; }
+    size_t kept() const { return m_kept; }
+    size_t rejected(Rejection rejection) const;
+    size_t rejected() const;
+    size_t failed() const { return m_failed; }
+    // Wall time from construction until finish(), or until now while the run goes on
+    double wall_seconds() const;
+    void finish();
+
+    // "runReactants 3.2 s, canonicalize 1.1 s, ..." for the slowest stages
+    std::string summary(size_t stages = 3) const;
+
+    // "rings 120, sanitize 3", empty if nothing was rejected
+    std::string rejection_summary() const;
+
+    // Stage totals, product, rejection and failure counts and the cost of every monomer and reaction, costliest first
+    void write_json(std::ostream &out, const std::vector<std::string> &reactionNames, const std::vector<std::string> &moleculeNames) const;
+
+    // Makes stats the target of the StageTimers of this thread until the scope ends
+    class Scope {
+    public:
+        explicit Scope(RunStats *stats);
+        ~Scope();
+    private:
+        RunStats *m_previous;
+    };
+
+    static RunStats *current();
+
+private:
+    struct Counter {
+        std::atomic<int64_t> ns{0};
+        std::atomic<size_t> calls{0};
+    };
+
+    Counter m_stages[size_t(Stage::Count)];
+    std::atomic<size_t> m_rejected[size_t(Rejection::Count)] = {};
+    std::unique_ptr<std::atomic<int64_t>[]> m_reactionNs, m_moleculeNs;
+    size_t m_reactions, m_molecules;
+    std::atomic<size_t> m_generated{0}, m_kept{0}, m_failed{0};
+    std::chrono::steady_clock::time_point m_start, m_end;
+    bool m_finished;
+};
+
+class StageTimer
+{
+public:
+    explicit StageTimer(Stage stage)
+        : m_stats(RunStats::current()), m_stage(stage)
+    {
+        if(m_stats){
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+    ~StageTimer(){
+        if(m_stats){
+            m_stats->add(m_stage, std::chrono::steady_clock::now() - m_start);
+        }
+    }
+
+private:
+    RunStats *m_stats;
+    Stage m_stage;
+    std::chrono::steady_clock::time_point m_start;
+};
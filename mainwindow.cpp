@@ -1,16 +1,36 @@
 #include "mainwindow.h"
-#include "molecule.h"
-#include "reaction.h"
-#include "reactiongenerator.h"
-#include "chemicalitem.h"
+#include "moleculemodel.h"
+#include "moleculedelegate.h"
+#include "reactionmodel.h"
+#include "reactiondelegate.h"
+#include "reactionlibrary.h"
+#include "gridrunner.h"
+#include "reactionengine.h"
+#include "inputloader.h"
+#include "reactionloader.h"
+#include "moleculereader.h"
+#include "productwriter.h"
+#include "resultcache.h"
+#include "instrumentation.h"
+#include "productstore.h"
+#include "projectfile.h"
 
 #include "./ui_mainwindow.h"
 
 #include <QTextStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QFileInfo>
 #include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPointer>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QTime>
 
 #include <GraphMol/FileParsers/FileParsers.h>
 #include <GraphMol/FileParsers/FileParserUtils.h>
@@ -19,36 +39,15 @@
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <GraphMol/MolOps.h>
 
+#include <fstream>
 
-void add_item(QTableWidget *table, QWidget* item, const std::string &header){
-    int rows = table->rowCount();
-    table->setRowCount(rows+1);
 
-    ChemicalItem *new_item = new ChemicalItem(table);
-    new_item->set_text(header);
-    new_item->set_widget(item);
-
-    table->setCellWidget(rows, 0, new_item);
-}
-
-
-void add_molecule(QTableWidget *table, const std::string &mol_path){
-
-    boost::shared_ptr<RDKit::RWMol> new_mol(RDKit::MolFileToMol(mol_path));
-    Molecule *mol = new Molecule(table);
-    mol->set_display_mol(new_mol);
-    mol->set_title(mol_path);
-    add_item(table, mol, mol_path);
-}
-
-void add_reaction(QTableWidget *table, const std::string &smarts){
-    boost::shared_ptr<RDKit::ChemicalReaction> new_react(RDKit::RxnSmartsToChemicalReaction(smarts));
-
-    ChemicalReactionWidget *react = new ChemicalReactionWidget(table);
-    react->set_smarts(smarts);
-    react->set_reaction(new_react);
-
-    add_item(table, react, smarts);
+namespace {
+    const QString molecule_file_filter = "Molecule files (*.mol *.mdl *.sdf *.sd *.smi *.smiles *.gz);;All files (*)";
+    const QString project_file_filter = "Dimer generator project (*.dgproj);;All files (*)";
+    const QString reaction_file_filter = "Reaction files (*.smarts *.txt *.rxn *.gz);;All files (*)";
+    const QString library_file_filter = "Reaction library (*.dgrxn);;Dimer generator project (*.dgproj);;All files (*)";
+    const QString product_file_filter = "SD file (*.sdf);;Compressed SD file (*.sdf.gz);;SMILES (*.smi);;Compressed SMILES (*.smi.gz)";
 }
 
 MainWindow::MainWindow(QWidget *parent)
@@ -57,14 +56,62 @@ MainWindow::MainWindow(QWidget *parent)
     , fileDialog(nullptr)
     , messageBox(nullptr)
     , reactionDialog(nullptr)
+    , inputModel(nullptr)
+    , outputModel(nullptr)
+    , reactionModel(nullptr)
+    , runner(nullptr)
+    , loader(nullptr)
+    , reactionLoader(nullptr)
 
 {
     ui->setupUi(this);
+    inputModel = new MoleculeModel(this);
+    ui->input_table->setModel(inputModel);
+    ui->input_table->setItemDelegate(new MoleculeDelegate(this));
+    ui->input_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    outputModel = new MoleculeModel(this);
+    ui->output_table->setModel(outputModel);
+    ui->output_table->setItemDelegate(new MoleculeDelegate(this));
+    ui->output_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    reactionModel = new ReactionModel(this);
+    ui->react_table->setModel(reactionModel);
+    ui->react_table->setItemDelegate(new ReactionDelegate(this));
+    ui->react_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     saveFileName = "";
     fileDialog = new QFileDialog(this);
     messageBox = new QMessageBox(this);
     reactionDialog = new ReactionDialog(this);
     connect(reactionDialog, SIGNAL(accepted()), this, SLOT(reactionDialogAccepted()));
+
+    runner = new GridRunner(this);
+    QSettings settings;
+    // Cells of earlier runs, trimmed to cache/maxMB after every run
+    if(settings.value("cache/enabled", true).toBool()){
+        resultCache = std::make_shared<ResultCache>(
+            (QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results").toStdString());
+        runner->set_cache(resultCache);
+    }
+    ui->actionClear_Result_Cache->setEnabled(bool(resultCache));
+    // Product limits, 0 disables a limit
+    ProductFilter filter;
+    filter.maxHeavyAtoms = settings.value("filter/maxHeavyAtoms", 0).toUInt();
+    filter.maxRings = settings.value("filter/maxRings", 0).toUInt();
+    filter.maxMolWt = settings.value("filter/maxMolWt", 0.0).toDouble();
+    runner->set_filter(filter);
+    OligomerOptions oligomers;
+    oligomers.maxLength = settings.value("oligomers/maxLength", 2).toUInt();
+    oligomers.maxFrontier = settings.value("oligomers/maxFrontier", 0).toULongLong();
+    runner->set_oligomers(oligomers);
+    connect(runner, &GridRunner::products_ready, this, &MainWindow::runProductsReady);
+    connect(runner, &GridRunner::progress, this, &MainWindow::runProgress);
+    connect(runner, &GridRunner::finished, this, &MainWindow::runFinished);
+
+    loader = new InputLoader(this);
+    connect(loader, &InputLoader::molecules_ready, this, &MainWindow::inputMoleculesReady);
+    connect(loader, &InputLoader::finished, this, &MainWindow::inputFinished);
+
+    reactionLoader = new ReactionLoader(this);
+    connect(reactionLoader, &ReactionLoader::finished, this, &MainWindow::reactionsLoaded);
 }
 
 MainWindow::~MainWindow()
@@ -80,125 +127,457 @@ void MainWindow::on_actionExit_triggered()
 
 void MainWindow::on_actionOpen_triggered()
 {
-    QString path = fileDialog->getExistingDirectory(this, "Select folder", "");
-    if (path.isEmpty()) return;
-
-    QStringList filters;
-    filters << "*.mol" << "*.mdl";
-    QDirIterator it(path, filters, QDir::Files);
-    QString badFiles = "";
-    while (it.hasNext()){
-        QString filePath = it.next();
-        try{
-            add_molecule(ui->input_table, filePath.toStdString());
-        }
-        catch(RDKit::BadFileException()){
-            badFiles += filePath + "\n";
+    QStringList paths = fileDialog->getOpenFileNames(this, "Select molecule files", "", molecule_file_filter);
+    if (paths.isEmpty()) return;
+
+    ui->statusbar->showMessage("Loading molecules...");
+    loader->start(paths);
+}
+
+void MainWindow::on_actionOpen_Folder_triggered()
+{
+    QString dir = fileDialog->getExistingDirectory(this, "Select molecule folder");
+    if (dir.isEmpty()) return;
+
+    ui->statusbar->showMessage("Loading molecules...");
+    loader->start(QStringList{dir});
+}
+
+void MainWindow::inputMoleculesReady(const std::vector<InputMolecule> &molecules)
+{
+    std::vector<MoleculeRecord> records;
+    records.reserve(molecules.size());
+    for(const auto &m: molecules){
+        records.push_back({m.name, m.mol});
+    }
+    inputModel->append(std::move(records));
+}
+
+void MainWindow::inputFinished(const std::vector<ReadError> &errors, bool cancelled)
+{
+    ui->statusbar->showMessage(QString("%1 molecules loaded").arg(inputModel->rowCount()));
+    if(!cancelled){
+        showReadErrors(errors);
+    }
+}
+
+void MainWindow::showReadErrors(const std::vector<ReadError> &errors)
+{
+    if(errors.empty()){
+        return;
+    }
+    const size_t maxListed = 50;
+    QString badRecords;
+    for(size_t i = 0; i < errors.size() && i < maxListed; i ++){
+        const ReadError &e = errors[i];
+        badRecords += QString::fromStdString(e.file);
+        if(e.record){
+            badRecords += QString(", record %1 at line %2").arg(e.record).arg(e.line);
         }
+        badRecords += ": " + QString::fromStdString(e.message) + "\n";
     }
-    if(!badFiles.isEmpty()){
-        messageBox->setText("Cannot read file correctly\n" + badFiles);
-        messageBox->setWindowTitle("Invalid file");
-        messageBox->exec();
+    if(errors.size() > maxListed){
+        badRecords += QString("... and %1 more\n").arg(errors.size() - maxListed);
     }
+    messageBox->setText("Cannot read file correctly\n" + badRecords);
+    messageBox->setWindowTitle("Invalid file");
+    messageBox->exec();
 }
 
 void MainWindow::on_actionSave_triggered()
 {
-
-    QString path = fileDialog->getExistingDirectory(this, "Select save directory", "");
+    QString path = fileDialog->getSaveFileName(this, "Save products", "", product_file_filter);
     if(path.isEmpty()){
         return;
     }
-    reactionDialog->show();
 
-    QEventLoop loop;
-    connect(this, &MainWindow::name_accepted, &loop, &QEventLoop::quit);
-    loop.exec(); //exec will delay execution until the signal has arrived
-    if(saveFileName.isEmpty()){
+    // No back-pressure, the GUI thread only queues the rows and the writer thread does the rest
+    auto writer = std::make_shared<ProductWriter>(path.toStdString(), 0);
+    if(!writer->ok()){
+        messageBox->setWindowTitle("Saving");
+        messageBox->setText(QString::fromStdString(writer->error()));
+        messageBox->exec();
         return;
     }
-    qDebug() << saveFileName;
 
-    int numberOfMolecules = ui->output_table->rowCount();
+    auto registry = outputModel->registry();
+    int numberOfMolecules = outputModel->rowCount();
     for(int i = 0; i < numberOfMolecules; i ++){
-        QFile file(path + "/" + saveFileName + "_" + QString::fromStdString(std::to_string(i)) + ".mol");
-        file.open(QFile::WriteOnly);
+        // Stored products are handed over as pickles and only rehydrated on the writer thread
+        const MoleculeRecord &r = outputModel->record(i);
+        auto store = outputModel->store();
+        ProductEntry entry{outputModel->title(i), r.mol, "", ""};
+        if(r.stored != MoleculeRecord::not_stored && store){
+            entry.pickle = store->pickle(r.stored);
+        }
+        auto producers = registry ? registry->provenance(entry.smiles) : std::vector<Provenance>();
+        if(!producers.empty()){
+            const Provenance &p = producers.front();
+            if(p.reaction < runReactionNames.size()){
+                entry.reaction = runReactionNames[p.reaction];
+            }
+            if(p.molecule < runMoleculeNames.size()){
+                entry.monomer = runMoleculeNames[p.molecule];
+            }
+            if(p.partner != p.molecule && p.partner < runMoleculeNames.size()){
+                entry.monomer += " + " + runMoleculeNames[p.partner];
+            }
+        }
+        writer->write(std::move(entry));
+    }
 
-        ChemicalItem* item = (ChemicalItem*)ui->output_table->cellWidget(i, 0);
-        Molecule* mol = (Molecule*)item->widget();
-        mol->display_mol()->setProp("_Name", item->text());
-        file.write(RDKit::MolToMolBlock(*mol->display_mol()).data());
+    ui->actionSave->setEnabled(false);
+    ui->statusbar->showMessage("Saving...");
+    QPointer<MainWindow> self(this);
+    QThreadPool::globalInstance()->start(QRunnable::create([self, writer](){
+        bool ok = writer->close();
+        QMetaObject::invokeMethod(self, [self, writer, ok](){
+            if(self){
+                self->saveFinished(ok, writer->written(), writer->skipped(),
+                                   QString::fromStdString(ok ? writer->skip_reason() : writer->error()));
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
 
-        file.close();
-    }
+void MainWindow::saveFinished(bool ok, size_t written, size_t skipped, const QString &error)
+{
+    ui->actionSave->setEnabled(true);
+    ui->statusbar->showMessage(ok ? QString("Saved %1 products").arg(written) : "Saving failed");
     messageBox->setWindowTitle("Saving");
-    messageBox->setText("Saving done");
+    QString done = "Saving done";
+    if(skipped){
+        done += QString(", %1 products could not be written, the first because of\n%2").arg(skipped).arg(error);
+    }
+    messageBox->setText(ok ? done : error);
     messageBox->show();
 }
 
+void MainWindow::on_actionOpen_Project_triggered()
+{
+    if(runner->is_running() || loader->is_running() || reactionLoader->is_running()){
+        ui->statusbar->showMessage("Stop the run or the loading first");
+        return;
+    }
+    QString path = fileDialog->getOpenFileName(this, "Open project", "", project_file_filter);
+    if(path.isEmpty()) return;
+
+    ProjectReader reader;
+    if(!reader.open(path.toStdString())){
+        messageBox->setWindowTitle("Opening project");
+        messageBox->setText(QString::fromStdString(reader.error()));
+        messageBox->exec();
+        return;
+    }
+
+    // Molecules and products stay in the mapped file, rows only point into it
+    inputModel->clear();
+    auto inputs = std::make_shared<ProductStore>();
+    size_t first = reader.adopt_molecules(*inputs);
+    inputModel->set_store(inputs);
+    std::vector<MoleculeRecord> records(reader.molecules());
+    for(size_t i = 0; i < records.size(); i ++){
+        records[i].stored = first + i;
+    }
+    inputModel->append(std::move(records));
+
+    reactionModel->clear();
+    ReactionLibrary reactions;
+    reactions.load(reader);
+    reactionModel->append(reactions);
+
+    outputModel->clear();
+    auto products = std::make_shared<ProductStore>();
+    first = reader.adopt_products(*products);
+    auto registry = std::make_shared<ProductRegistry>();
+    reader.fill_registry(*registry);
+    outputModel->set_store(products);
+    outputModel->set_registry(registry);
+    outputModel->set_stats(nullptr);
+    records.assign(reader.products(), MoleculeRecord());
+    for(size_t i = 0; i < records.size(); i ++){
+        records[i].stored = first + i;
+    }
+    outputModel->append(std::move(records));
+    runReactionNames = reader.run_reaction_names();
+    runMoleculeNames = reader.run_molecule_names();
+
+    ui->statusbar->showMessage(QString("Opened %1: %2 molecules, %3 reactions, %4 products")
+                               .arg(path).arg(reader.molecules()).arg(reader.reactions()).arg(reader.products()));
+}
+
+void MainWindow::on_actionSave_Project_triggered()
+{
+    if(runner->is_running()){
+        ui->statusbar->showMessage("Stop the run before saving the project");
+        return;
+    }
+    QString path = fileDialog->getSaveFileName(this, "Save project", "", project_file_filter);
+    if(path.isEmpty()) return;
+    if(QFileInfo(path).suffix().isEmpty()){
+        path += ".dgproj";
+    }
+
+    ProjectWriter writer;
+    auto inputs = inputModel->store();
+    for(int j = 0; j < inputModel->rowCount(); j ++){
+        const MoleculeRecord &r = inputModel->record(j);
+        if(r.stored != MoleculeRecord::not_stored && inputs){
+            writer.add_molecule(inputModel->title(j), inputs->pickle(r.stored));
+        }
+        else{
+            writer.add_molecule(r.title, *r.mol);
+        }
+    }
+
+    for(const auto &r: reactionModel->library().reactions()){
+        writer.add_reaction(r.name, *r.rxn);
+    }
+
+    auto products = outputModel->store();
+    auto registry = outputModel->registry();
+    for(int i = 0; i < outputModel->rowCount(); i ++){
+        const MoleculeRecord &r = outputModel->record(i);
+        std::string key = outputModel->title(i);
+        auto producers = registry ? registry->provenance(key) : std::vector<Provenance>();
+        if(r.stored != MoleculeRecord::not_stored && products){
+            writer.add_product(key, products->pickle(r.stored), producers);
+        }
+    }
+    writer.set_run_names(runReactionNames, runMoleculeNames);
+
+    if(!writer.write(path.toStdString())){
+        messageBox->setWindowTitle("Saving project");
+        messageBox->setText(QString::fromStdString(writer.error()));
+        messageBox->exec();
+        return;
+    }
+    ui->statusbar->showMessage("Project saved to " + path);
+}
+
 void MainWindow::on_actionRun_triggered()
 {
-    ui->output_table->setRowCount(0);
+    if(runner->is_running()){
+        return;
+    }
+    outputModel->clear();
 
-    int numberOfReactions = ui->react_table->rowCount();
-    int numberOfMolecules = ui->input_table->rowCount();
+    int numberOfReactions = reactionModel->rowCount();
+    int numberOfMolecules = inputModel->rowCount();
     if(!numberOfMolecules || !numberOfReactions){
         return;
     }
 
-    for(int i = 0; i < numberOfReactions; i ++){
-        ui->progressBar->setValue((i+1) * 100.f / numberOfReactions);
-        ChemicalItem *item = (ChemicalItem*)ui->react_table->cellWidget(i, 0);
-        ChemicalReactionWidget *react = ((ChemicalReactionWidget*)item->widget());
-        for(int j = 0; j < numberOfMolecules; j ++){
-            ChemicalItem *m = (ChemicalItem*)ui->input_table->cellWidget(j, 0);
-            RDKit::ROMOL_SPTR curr_mol = ((Molecule*)m->widget())->display_mol();
+    std::vector<RXN_SPTR> reactions;
+    runReactionNames.clear();
+    for(const auto &r: reactionModel->library().reactions()){
+        reactions.push_back(r.rxn);
+        runReactionNames.push_back(r.name);
+    }
 
-            auto res = react->run(curr_mol, ui->output_table, this->windowFlags());
-            for(Molecule* new_mol: res){
-                add_item(ui->output_table, new_mol, new_mol->title());
-            }
-        }
+    std::vector<RDKit::ROMOL_SPTR> molecules;
+    runMoleculeNames.clear();
+    for(int j = 0; j < numberOfMolecules; j ++){
+        molecules.push_back(inputModel->molecule(j));
+        runMoleculeNames.push_back(inputModel->title(j));
     }
-    return;
+
+    ui->progressBar->setValue(0);
+    ui->actionRun->setEnabled(false);
+    ui->actionPause->setEnabled(true);
+    ui->actionStop->setEnabled(true);
+    runner->set_cross_pairs(ui->actionCross_Dimers->isChecked());
+    runner->start(reactions, molecules);
+    outputModel->set_registry(runner->registry());
+    outputModel->set_store(runner->store());
+    outputModel->set_stats(runner->stats());
 }
 
-void MainWindow::on_actionAdd_Reaction_triggered()
+void MainWindow::on_actionPause_triggered(bool checked)
+{
+    if(checked){
+        runner->pause();
+        ui->statusbar->showMessage("Paused");
+    }
+    else{
+        runner->resume();
+    }
+}
+
+void MainWindow::on_actionStop_triggered()
+{
+    runner->cancel();
+}
+
+void MainWindow::runProductsReady(int reaction, int molecule, const std::vector<MoleculeRecord> &products)
 {
-    std::vector<RDKit::ROMOL_SPTR> mols;
+    RunStats::Scope scope(runner->stats().get());
+    StageTimer timer(Stage::Display);
+    outputModel->append(products);
+}
 
-    //add_reaction(ui->react_table, "([RH1:1]).([RH1:2])>>[RH1:1]/C=C/[RH1:2]");
-    QString path = fileDialog->getExistingDirectory(this, "Select folder", "");
-    if (path.isEmpty()) return;
+void MainWindow::runProgress(int done, int total, qint64 eta_ms)
+{
+    ui->progressBar->setValue(done * 100.f / total);
+    if(!runner->is_paused()){
+        ui->statusbar->showMessage(QString("%1/%2 cells, ETA %3")
+                                   .arg(done).arg(total)
+                                   .arg(QTime(0, 0).addMSecs(eta_ms).toString("hh:mm:ss")));
+    }
+}
 
-    QStringList filters;
-    filters << "*.mol" << "*.mdl";
-    QDirIterator it(path, filters, QDir::Files);
-    QString badFiles;
-    while (it.hasNext()){
-        QString filePath = it.next();
-        try{
-            mols.push_back(RDKit::ROMOL_SPTR(RDKit::MolFileToMol(filePath.toStdString())));
+void MainWindow::runFinished(bool cancelled)
+{
+    ui->actionRun->setEnabled(true);
+    ui->actionPause->setChecked(false);
+    ui->actionPause->setEnabled(false);
+    ui->actionStop->setEnabled(false);
+    auto registry = runner->registry();
+    QString message = cancelled ? "Run cancelled" : QString("Done, %1 products, %2 duplicates dropped")
+                                                        .arg(outputModel->rowCount())
+                                                        .arg(registry ? registry->duplicates() : 0);
+    auto store = runner->store();
+    if(store && !cancelled){
+        message += QString(", %1 MB of pickles").arg(store->bytes() / 1048576.0, 0, 'f', 1);
+    }
+
+    auto stats = runner->stats();
+    if(stats){
+        message += QString(" in %1 s (%2)").arg(stats->wall_seconds(), 0, 'f', 1)
+                                           .arg(QString::fromStdString(stats->summary()));
+        if(stats->rejected()){
+            message += QString(", %1 rejected (%2)").arg(stats->rejected())
+                                                    .arg(QString::fromStdString(stats->rejection_summary()));
         }
-        catch(RDKit::BadFileException()){
-            badFiles += filePath + "\n";
+        QString report = writeRunReport(*stats);
+        if(!report.isEmpty()){
+            message += ", report in " + report;
         }
     }
-    if(!badFiles.isEmpty()){
-        messageBox->setText("Cannot read file correctly\n" + badFiles);
-        messageBox->setWindowTitle("Invalid file");
+    ui->statusbar->showMessage(message);
+
+    // Trimmed in the background; a trim racing the next run only costs it some misses
+    uint64_t maxBytes = QSettings().value("cache/maxMB", 2048).toULongLong() * 1048576;
+    if(resultCache && maxBytes){
+        std::shared_ptr<const ResultCache> cache = resultCache;
+        QThreadPool::globalInstance()->start(QRunnable::create([cache, maxBytes](){
+            cache->trim(maxBytes);
+        }));
+    }
+}
+
+QString MainWindow::writeRunReport(const RunStats &stats)
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/reports");
+    if(!dir.mkpath(".")){
+        return QString();
+    }
+    QString path = dir.filePath("run-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json");
+    std::ofstream out(path.toStdString());
+    if(!out){
+        return QString();
+    }
+    stats.write_json(out, runReactionNames, runMoleculeNames);
+    return out ? path : QString();
+}
+
+void MainWindow::on_actionAdd_Reaction_triggered()
+{
+    if(runner->is_running()){
+        ui->statusbar->showMessage("Stop the run before changing the reactions");
+        return;
+    }
+    QStringList paths = fileDialog->getOpenFileNames(this, "Select bridge templates", "", molecule_file_filter);
+    if (paths.isEmpty()) return;
+
+    ui->statusbar->showMessage("Generating bridges...");
+    reactionLoader->start_bridges(paths);
+}
+
+void MainWindow::on_actionAdd_Bridge_Folder_triggered()
+{
+    if(runner->is_running()){
+        ui->statusbar->showMessage("Stop the run before changing the reactions");
+        return;
+    }
+    QString dir = fileDialog->getExistingDirectory(this, "Select bridge template folder");
+    if (dir.isEmpty()) return;
+
+    ui->statusbar->showMessage("Generating bridges...");
+    reactionLoader->start_bridges(QStringList{dir});
+}
+
+void MainWindow::on_actionImport_Reactions_triggered()
+{
+    if(runner->is_running()){
+        ui->statusbar->showMessage("Stop the run before changing the reactions");
+        return;
+    }
+    QStringList paths = fileDialog->getOpenFileNames(this, "Import reactions", "", reaction_file_filter);
+    if(paths.isEmpty()) return;
+
+    ui->statusbar->showMessage("Importing reactions...");
+    reactionLoader->start_import(paths);
+}
+
+void MainWindow::on_actionOpen_Reaction_Library_triggered()
+{
+    if(runner->is_running()){
+        ui->statusbar->showMessage("Stop the run before changing the reactions");
+        return;
+    }
+    QString path = fileDialog->getOpenFileName(this, "Open reaction library", "", library_file_filter);
+    if(path.isEmpty()) return;
+
+    ui->statusbar->showMessage("Loading reactions...");
+    reactionLoader->start_library(path);
+}
+
+void MainWindow::reactionsLoaded(std::shared_ptr<const ReactionLibrary> library, const std::vector<ReadError> &errors,
+                                 const QString &error)
+{
+    if(!error.isEmpty()){
+        ui->statusbar->clearMessage();
+        messageBox->setWindowTitle("Loading reactions");
+        messageBox->setText(error);
         messageBox->exec();
+        return;
     }
+    showReadErrors(errors);
+    // A run started meanwhile keeps its own copy of the reactions
+    size_t added = reactionModel->append(*library);
+    ui->statusbar->showMessage(QString("%1 reactions added, %2 already listed")
+                               .arg(added).arg(library->size() - added + library->duplicates()));
+}
 
-    reactionGenerator gen;
-    auto res = gen.generate_reactions(mols, this);
+void MainWindow::on_actionClear_Result_Cache_triggered()
+{
+    if(runner->is_running()){
+        ui->statusbar->showMessage("Stop the run before clearing the result cache");
+        return;
+    }
+    if(resultCache){
+        resultCache->clear();
+        ui->statusbar->showMessage("Result cache cleared");
+    }
+}
 
-    for(auto &p: res){
-        add_item(ui->react_table, p.second, p.second->smarts());
+void MainWindow::on_actionSave_Reaction_Library_triggered()
+{
+    QString path = fileDialog->getSaveFileName(this, "Save reaction library", "", library_file_filter);
+    if(path.isEmpty()) return;
+    if(QFileInfo(path).suffix().isEmpty()){
+        path += ".dgrxn";
     }
 
-    return;
+    std::string error;
+    if(!reactionModel->library().save(path.toStdString(), error)){
+        messageBox->setWindowTitle("Saving reaction library");
+        messageBox->setText(QString::fromStdString(error));
+        messageBox->exec();
+        return;
+    }
+    ui->statusbar->showMessage(QString("%1 reactions saved to %2").arg(reactionModel->rowCount()).arg(path));
 }
 
 void MainWindow::reactionDialogAccepted()
@@ -5,6 +5,16 @@
 #include <QMessageBox>
 
 #include "reactiondialog.h"
+#include "moleculemodel.h"
+#include "moleculereader.h"
+
+class GridRunner;
+class InputLoader;
+class ReactionLibrary;
+class ReactionLoader;
+class ReactionModel;
+class ResultCache;
+class RunStats;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -29,20 +39,64 @@ private slots:
 
     void on_actionOpen_triggered();
 
+    void on_actionOpen_Folder_triggered();
+
     void on_actionSave_triggered();
 
+    void on_actionOpen_Project_triggered();
+
+    void on_actionSave_Project_triggered();
+
+    void on_actionImport_Reactions_triggered();
+
+    void on_actionOpen_Reaction_Library_triggered();
+
+    void on_actionSave_Reaction_Library_triggered();
+
+    void on_actionClear_Result_Cache_triggered();
+
     void on_actionRun_triggered();
 
     void on_actionAdd_Reaction_triggered();
 
+    void on_actionAdd_Bridge_Folder_triggered();
+
+    void on_actionPause_triggered(bool checked);
+
+    void on_actionStop_triggered();
+
     void reactionDialogAccepted();
 
+    void runProductsReady(int reaction, int molecule, const std::vector<MoleculeRecord> &products);
+
+    void runProgress(int done, int total, qint64 eta_ms);
+
+    void runFinished(bool cancelled);
+
+    void inputMoleculesReady(const std::vector<InputMolecule> &molecules);
+
+    void inputFinished(const std::vector<ReadError> &errors, bool cancelled);
+
+    void reactionsLoaded(std::shared_ptr<const ReactionLibrary> library, const std::vector<ReadError> &errors, const QString &error);
+
+    void saveFinished(bool ok, size_t written, size_t skipped, const QString &error);
+
 private:
     Ui::MainWindow *ui;
     QFileDialog *fileDialog;
     QString filePath, saveFileName;
     QMessageBox *messageBox;
     ReactionDialog *reactionDialog;
+    MoleculeModel *inputModel;
+    MoleculeModel *outputModel;
+    ReactionModel *reactionModel;
+    GridRunner *runner;
+    InputLoader *loader;
+    ReactionLoader *reactionLoader;
+    std::shared_ptr<ResultCache> resultCache; // Null when cache/enabled is off
+    std::vector<std::string> runReactionNames, runMoleculeNames; // Provenance of the products on display
 
     void handleResults();
+    void showReadErrors(const std::vector<ReadError> &errors);
+    QString writeRunReport(const RunStats &stats);
 };
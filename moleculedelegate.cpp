@@ -0,0 +1,25 @@
+#include "moleculedelegate.h"
+#include "moleculemodel.h"
+
+#include <GraphMol/MolDraw2D/Qt/MolDraw2DQt.h>
+
+MoleculeDelegate::MoleculeDelegate(QObject *parent)
+    : StructureDelegate{parent}
+{
+}
+
+bool MoleculeDelegate::structure(const QModelIndex &index, Structure &s) const{
+    const MoleculeModel *model = qobject_cast<const MoleculeModel*>(index.model());
+    if(!model){
+        return false;
+    }
+    RDKit::ROMOL_SPTR mol = model->depiction(index.row());
+    if(mol){
+        s.identity = mol.get();
+        s.name = QString::fromStdString(model->title(index.row()));
+        s.draw = [mol](RDKit::MolDraw2DQt &drawer){
+            drawer.drawMolecule(*mol);
+        };
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "structuredelegate.h"
+
+// Draws the molecule of a MoleculeModel row with its title underneath
+class MoleculeDelegate : public StructureDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit MoleculeDelegate(QObject *parent = nullptr);
+
+protected:
+    bool structure(const QModelIndex &index, Structure &s) const override;
+};
@@ -0,0 +1,165 @@
+#include "moleculemodel.h"
+#include "depiction.h"
+#include "productregistry.h"
+#include "productstore.h"
+#include "instrumentation.h"
+
+#include <QRunnable>
+#include <QThread>
+
+#include <algorithm>
+
+MoleculeModel::MoleculeModel(QObject *parent)
+    : QAbstractTableModel{parent},
+      m_generation(0),
+      m_depictions(4096)
+{
+    m_depictPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+MoleculeModel::~MoleculeModel(){
+    m_depictPool.clear();
+    m_depictPool.waitForDone();
+}
+
+int MoleculeModel::rowCount(const QModelIndex &parent) const{
+    return parent.isValid() ? 0 : int(m_records.size());
+}
+
+int MoleculeModel::columnCount(const QModelIndex &parent) const{
+    return parent.isValid() ? 0 : 1;
+}
+
+QVariant MoleculeModel::data(const QModelIndex &index, int role) const{
+    if(!index.isValid() || index.row() >= rowCount()){
+        return QVariant();
+    }
+    if(role == Qt::DisplayRole){
+        return QString::fromStdString(title(index.row()));
+    }
+    if(role == Qt::ToolTipRole){
+        std::string key = title(index.row());
+        QString tip = QString::fromStdString(key);
+        if(m_registry){
+            auto producers = m_registry->provenance(key);
+            tip += QString("\nProduced %1 time(s):").arg(producers.size());
+            for(const auto &p: producers){
+                if(p.partner != p.molecule){
+                    tip += QString("\n  reaction %1, molecules %2 + %3").arg(p.reaction + 1).arg(p.molecule + 1).arg(p.partner + 1);
+                }
+                else{
+                    tip += QString("\n  reaction %1, molecule %2").arg(p.reaction + 1).arg(p.molecule + 1);
+                }
+            }
+        }
+        return tip;
+    }
+    return QVariant();
+}
+
+void MoleculeModel::append(std::vector<MoleculeRecord> records){
+    if(records.empty()){
+        return;
+    }
+    int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + int(records.size()) - 1);
+    m_records.reserve(m_records.size() + records.size());
+    for(auto &r: records){
+        m_records.push_back(std::move(r));
+    }
+    endInsertRows();
+}
+
+void MoleculeModel::clear(){
+    beginResetModel();
+    m_depictPool.clear();
+    m_generation ++;
+    m_records.clear();
+    m_records.shrink_to_fit();
+    m_depictions.clear();
+    endResetModel();
+}
+
+void MoleculeModel::set_registry(std::shared_ptr<const ProductRegistry> registry){
+    m_registry = std::move(registry);
+}
+
+std::shared_ptr<const ProductRegistry> MoleculeModel::registry() const{
+    return m_registry;
+}
+
+void MoleculeModel::set_stats(std::shared_ptr<RunStats> stats){
+    m_stats = std::move(stats);
+}
+
+void MoleculeModel::set_store(std::shared_ptr<const ProductStore> store){
+    m_store = std::move(store);
+}
+
+std::shared_ptr<const ProductStore> MoleculeModel::store() const{
+    return m_store;
+}
+
+const MoleculeRecord &MoleculeModel::record(int row) const{
+    return m_records[row];
+}
+
+std::string MoleculeModel::title(int row) const{
+    const MoleculeRecord &r = m_records[row];
+    return r.stored != MoleculeRecord::not_stored && m_store ? m_store->key(r.stored) : r.title;
+}
+
+RDKit::ROMOL_SPTR MoleculeModel::molecule(int row) const{
+    const MoleculeRecord &r = m_records[row];
+    return r.stored != MoleculeRecord::not_stored && m_store ? m_store->molecule(r.stored) : r.mol;
+}
+
+RDKit::ROMOL_SPTR MoleculeModel::depiction(int row) const{
+    const MoleculeRecord &r = m_records[row];
+    if(RDKit::ROMOL_SPTR *cached = m_depictions.object(row)){
+        return *cached;
+    }
+    bool stored = r.stored != MoleculeRecord::not_stored && m_store;
+    if(r.depicting || (!r.mol && !stored)){
+        return nullptr;
+    }
+
+    // Coordinates are only generated for rows that are shown, off the GUI thread,
+    // and stored products are rehydrated there as well
+    r.depicting = true;
+    RDKit::ROMOL_SPTR mol = r.mol;
+    std::shared_ptr<const ProductStore> store = stored ? m_store : nullptr;
+    size_t index = r.stored;
+    unsigned int generation = m_generation;
+    MoleculeModel *self = const_cast<MoleculeModel*>(this);
+    std::shared_ptr<RunStats> stats = m_stats;
+    m_depictPool.start(QRunnable::create([self, mol, store, index, generation, row, stats]() mutable{
+        RunStats::Scope scope(stats.get());
+        RDKit::ROMOL_SPTR res;
+        try{
+            if(store){
+                mol = store->molecule(index);
+            }
+            res = prepare_depiction(*mol);
+        }
+        catch(const std::exception &){
+            res = mol; // Drawn without computed coordinates rather than not at all
+        }
+        QMetaObject::invokeMethod(self, [self, generation, row, res](){
+            self->depiction_done(generation, row, res);
+        }, Qt::QueuedConnection);
+    }));
+    return nullptr;
+}
+
+void MoleculeModel::depiction_done(unsigned int generation, int row, RDKit::ROMOL_SPTR depiction){
+    if(generation != m_generation || row >= rowCount()){
+        return;
+    }
+    m_records[row].depicting = false;
+    if(depiction){
+        m_depictions.insert(row, new RDKit::ROMOL_SPTR(std::move(depiction)));
+    }
+    QModelIndex idx = index(row, 0);
+    emit dataChanged(idx, idx);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QThreadPool>
+
+#include <GraphMol/GraphMol.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class ProductRegistry;
+class ProductStore;
+class RunStats;
+
+// A row is either a live molecule with its title, or an index into the
+// model's ProductStore, which then holds both its key and its pickle
+struct MoleculeRecord {
+    static constexpr size_t not_stored = size_t(-1);
+
+    std::string title;
+    RDKit::ROMOL_SPTR mol;
+    size_t stored = not_stored;
+    mutable bool depicting = false; // A worker is computing the depiction
+};
+
+// Lightweight table of molecules; nothing is depicted until a view asks for it,
+// and then on a worker thread. The row is repainted when its depiction is ready.
+// Only the depictions of recently drawn rows are kept.
+class MoleculeModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit MoleculeModel(QObject *parent = nullptr);
+    ~MoleculeModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void append(std::vector<MoleculeRecord> records);
+    void clear();
+
+    // Lists the producers of each row in its tool tip
+    void set_registry(std::shared_ptr<const ProductRegistry> registry);
+    std::shared_ptr<const ProductRegistry> registry() const;
+
+    // Depiction time is accounted to these run stats
+    void set_stats(std::shared_ptr<RunStats> stats);
+
+    // Arena holding the stored rows, which are appended afterwards
+    void set_store(std::shared_ptr<const ProductStore> store);
+    std::shared_ptr<const ProductStore> store() const;
+
+    const MoleculeRecord &record(int row) const;
+    std::string title(int row) const;
+
+    // The molecule of the row, rehydrated from the store for stored rows
+    RDKit::ROMOL_SPTR molecule(int row) const;
+
+    // Cached depiction of the row, or null while it is being computed
+    RDKit::ROMOL_SPTR depiction(int row) const;
+
+private:
+    void depiction_done(unsigned int generation, int row, RDKit::ROMOL_SPTR depiction);
+
+    std::vector<MoleculeRecord> m_records;
+    unsigned int m_generation; // Bumped by clear() so late depictions of removed rows are dropped
+    mutable QThreadPool m_depictPool;
+    mutable QCache<int, RDKit::ROMOL_SPTR> m_depictions;
+    std::shared_ptr<const ProductStore> m_store;
+    std::shared_ptr<const ProductRegistry> m_registry;
+    std::shared_ptr<RunStats> m_stats;
+};
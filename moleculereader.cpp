@@ -0,0 +1,243 @@
+#include "moleculereader.h"
+#include "parallel.h"
+
+#include <GraphMol/FileParsers/FileParsers.h>
+#include <GraphMol/SmilesParse/SmilesParse.h>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+namespace {
+    enum class Format { None, MolBlock, Smiles };
+
+    struct RawRecord {
+        size_t record;
+        size_t line;
+        std::string text;
+    };
+
+    bool has_suffix(const std::string &s, const std::string &suffix){
+        return s.size() >= suffix.size() && std::equal(suffix.rbegin(), suffix.rend(), s.rbegin(),
+                                                       [](char a, char b){ return a == std::tolower((unsigned char)b); });
+    }
+
+    bool is_gzipped(const std::string &path){
+        return has_suffix(path, ".gz");
+    }
+
+    Format format_of(std::string path){
+        if(is_gzipped(path)){
+            path.resize(path.size() - 3);
+        }
+        for(const char *ext: {".sdf", ".sd", ".mol", ".mdl"}){
+            if(has_suffix(path, ext)){
+                return Format::MolBlock;
+            }
+        }
+        for(const char *ext: {".smi", ".smiles"}){
+            if(has_suffix(path, ext)){
+                return Format::Smiles;
+            }
+        }
+        return Format::None;
+    }
+
+    bool next_line(std::istream &in, std::string &line, size_t &lineNo){
+        if(!std::getline(in, line)){
+            return false;
+        }
+        if(!line.empty() && line.back() == '\r'){
+            line.pop_back();
+        }
+        lineNo ++;
+        return true;
+    }
+
+    // SD records end with a "$$$$" line, a plain mol file is one record without it
+    bool next_molblock(std::istream &in, RawRecord &rec, size_t &lineNo){
+        std::string line;
+        rec.text.clear();
+        rec.line = lineNo + 1;
+        bool blank = true;
+        while(next_line(in, line, lineNo)){
+            if(line.compare(0, 4, "$$$$") == 0){
+                return true;
+            }
+            blank = blank && line.find_first_not_of(" \t") == std::string::npos;
+            rec.text += line;
+            rec.text += '\n';
+        }
+        return !blank;
+    }
+
+    // One "SMILES name" record per line, blank lines and # comments are skipped
+    bool next_smiles(std::istream &in, RawRecord &rec, size_t &lineNo){
+        std::string line;
+        while(next_line(in, line, lineNo)){
+            size_t start = line.find_first_not_of(" \t");
+            if(start == std::string::npos || line[start] == '#'){
+                continue;
+            }
+            rec.text = line.substr(start);
+            rec.line = lineNo;
+            return true;
+        }
+        return false;
+    }
+
+    RDKit::ROMol *parse_record(const RawRecord &rec, Format format, std::string &name){
+        if(format == Format::MolBlock){
+            RDKit::ROMol *mol = RDKit::MolBlockToMol(rec.text);
+            if(mol){
+                mol->getPropIfPresent("_Name", name);
+            }
+            return mol;
+        }
+
+        size_t split = rec.text.find_first_of(" \t");
+        if(split != std::string::npos){
+            size_t start = rec.text.find_first_not_of(" \t", split);
+            if(start != std::string::npos){
+                name = rec.text.substr(start);
+            }
+        }
+        RDKit::ROMol *mol = RDKit::SmilesToMol(rec.text.substr(0, split));
+        if(mol){
+            mol->setProp("_Name", name);
+        }
+        return mol;
+    }
+
+    ReadBatch parse_batch(const std::vector<RawRecord> &records, Format format, const std::string &file){
+        std::vector<InputMolecule> parsed(records.size());
+        std::vector<std::string> errors(records.size());
+        parallel_for(records.size(), [&](size_t i){
+            try{
+                parsed[i].mol.reset(parse_record(records[i], format, parsed[i].name));
+                if(!parsed[i].mol){
+                    errors[i] = "invalid record";
+                }
+            }
+            catch(const std::exception &e){
+                errors[i] = e.what();
+            }
+        });
+
+        ReadBatch res;
+        res.molecules.reserve(records.size());
+        for(size_t i = 0; i < records.size(); i ++){
+            if(!parsed[i].mol){
+                res.errors.push_back({file, records[i].record, records[i].line, errors[i]});
+                continue;
+            }
+            if(parsed[i].name.empty()){
+                parsed[i].name = file + "#" + std::to_string(records[i].record);
+            }
+            res.molecules.push_back(std::move(parsed[i]));
+        }
+        return res;
+    }
+
+    bool file_error(const std::string &file, const std::string &message, const BATCH_CALLBACK &callback){
+        ReadBatch batch;
+        batch.errors.push_back({file, 0, 0, message});
+        return callback(batch);
+    }
+
+    bool read_file(const std::string &file, const BATCH_CALLBACK &callback, size_t batchSize){
+        Format format = format_of(file);
+        if(format == Format::None){
+            return file_error(file, "unknown file format", callback);
+        }
+
+        std::ifstream raw(file, std::ios::binary);
+        if(!raw){
+            return file_error(file, "cannot open file", callback);
+        }
+        boost::iostreams::filtering_istream in;
+        if(is_gzipped(file)){
+            in.push(boost::iostreams::gzip_decompressor());
+        }
+        in.push(raw);
+
+        // The next batch is read while the previous one is parsed
+        std::future<ReadBatch> pending;
+        size_t lineNo = 0, recordNo = 0;
+        std::string readError;
+        while(true){
+            std::vector<RawRecord> records;
+            try{
+                RawRecord rec;
+                while(records.size() < batchSize
+                      && (format == Format::MolBlock ? next_molblock(in, rec, lineNo) : next_smiles(in, rec, lineNo))){
+                    rec.record = ++recordNo;
+                    records.push_back(std::move(rec));
+                }
+            }
+            catch(const std::exception &e){
+                readError = e.what(); // Truncated or corrupt gzip stream, what was read so far is kept
+            }
+
+            if(pending.valid()){
+                ReadBatch batch = pending.get();
+                if(!callback(batch)){
+                    return false;
+                }
+            }
+            if(records.empty()){
+                break;
+            }
+            pending = std::async(std::launch::async, [records = std::move(records), format, file](){
+                return parse_batch(records, format, file);
+            });
+            if(!readError.empty()){
+                ReadBatch batch = pending.get();
+                if(!callback(batch)){
+                    return false;
+                }
+                break;
+            }
+        }
+
+        if(!readError.empty()){
+            ReadBatch batch;
+            batch.errors.push_back({file, recordNo + 1, lineNo + 1, readError});
+            return callback(batch);
+        }
+        return true;
+    }
+}
+
+bool is_molecule_file(const std::string &path){
+    return format_of(path) != Format::None;
+}
+
+bool read_molecules(const std::string &path, const BATCH_CALLBACK &callback, size_t batchSize){
+    batchSize = std::max<size_t>(batchSize, 1);
+
+    std::error_code ec;
+    if(!std::filesystem::is_directory(path, ec)){
+        return read_file(path, callback, batchSize);
+    }
+
+    std::vector<std::string> files;
+    for(const auto &entry: std::filesystem::directory_iterator(path, ec)){
+        if(entry.is_regular_file() && is_molecule_file(entry.path().string())){
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for(const auto &file: files){
+        if(!read_file(file, callback, batchSize)){
+            return false;
+        }
+    }
+    return true;
+}
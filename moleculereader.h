@@ -0,0 +1,42 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <GraphMol/GraphMol.h>
+
+// Streaming reader for monomer libraries: single .mol/.mdl files, multi-record
+// SDF and SMILES files, any of them gzipped, and directories of such files.
+// Records are read in batches and each batch is parsed on all cores while the
+// next one is read, so the first molecules arrive long before the file is done.
+
+struct InputMolecule {
+    std::string name;
+    RDKit::ROMOL_SPTR mol;
+};
+
+// A record that could not be parsed, located by its position in the file
+struct ReadError {
+    std::string file;
+    size_t record; // 1-based record number within the file
+    size_t line;   // 1-based line on which the record starts
+    std::string message;
+};
+
+struct ReadBatch {
+    std::vector<InputMolecule> molecules;
+    std::vector<ReadError> errors;
+};
+
+// Called once per batch, in file order. Returning false stops the read.
+typedef std::function<bool(ReadBatch &batch)> BATCH_CALLBACK;
+
+// True if the file name has an extension read_molecules understands
+bool is_molecule_file(const std::string &path);
+
+// Reads every record of path, which may be a file or a directory, and hands
+// them out in batches of at most batchSize. Returns false if it was stopped
+// by the callback. Errors that affect a whole file, such as a file that cannot
+// be opened, are reported as a ReadError with record 0.
+bool read_molecules(const std::string &path, const BATCH_CALLBACK &callback, size_t batchSize = 1024);
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Calls fn(i) for every i in [0, n) on all cores of the machine. Indices are
+// handed out one at a time so uneven items balance out; the caller's thread
+// takes part. The first exception thrown by fn is rethrown once all threads joined.
+template<typename F>
+void parallel_for(size_t n, F fn, unsigned int threads = 0){
+    size_t count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    count = std::min(count, n);
+    if(count <= 1){
+        for(size_t i = 0; i < n; i ++){
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&](){
+        for(size_t i = next++; i < n; i = next++){
+            try{
+                fn(i);
+            }
+            catch(...){
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!error){
+                    error = std::current_exception();
+                }
+                next = n;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(size_t t = 1; t < count; t ++){
+        pool.emplace_back(worker);
+    }
+    worker();
+    for(auto &t: pool){
+        t.join();
+    }
+    if(error){
+        std::rethrow_exception(error);
+    }
+}
+
+// Unordered pairs (a, b), a <= b, of n items grouped into (n + 1) / 2 tasks of about
+// n + 1 pairs each: task t holds rows t and n - 1 - t of the upper triangle, a short
+// row with a long one. Calls fn(a, b) for every pair of the task.
+inline size_t cross_pair_tasks(size_t n){
+    return (n + 1) / 2;
+}
+
+template<typename F>
+void for_each_cross_pair(size_t n, size_t task, F fn){
+    size_t rows[2] = {task, n - 1 - task};
+    for(size_t r = 0; r < (rows[0] == rows[1] ? 1 : 2); r ++){
+        for(size_t b = rows[r]; b < n; b ++){
+            fn(rows[r], b);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#include "productregistry.h"
+
+ProductRegistry::ProductRegistry(unsigned int shards)
+    : m_shards(shards ? shards : 1)
+{
+}
+
+ProductRegistry::Shard &ProductRegistry::shard(const std::string &key){
+    return m_shards[std::hash<std::string>()(key) % m_shards.size()];
+}
+
+const ProductRegistry::Shard &ProductRegistry::shard(const std::string &key) const{
+    return m_shards[std::hash<std::string>()(key) % m_shards.size()];
+}
+
+bool ProductRegistry::insert(const std::string &key, unsigned int reaction, unsigned int molecule, unsigned int partner){
+    Shard &s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.entries.try_emplace(key);
+    it.first->second.push_back({reaction, molecule, partner});
+    if(!it.second){
+        s.duplicates ++;
+    }
+    return it.second;
+}
+
+std::vector<Provenance> ProductRegistry::provenance(const std::string &key) const{
+    const Shard &s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.entries.find(key);
+    if(it == s.entries.end()){
+        return {};
+    }
+    return it->second;
+}
+
+size_t ProductRegistry::size() const{
+    size_t res = 0;
+    for(const auto &s: m_shards){
+        std::lock_guard<std::mutex> lock(s.mutex);
+        res += s.entries.size();
+    }
+    return res;
+}
+
+size_t ProductRegistry::duplicates() const{
+    size_t res = 0;
+    for(const auto &s: m_shards){
+        std::lock_guard<std::mutex> lock(s.mutex);
+        res += s.duplicates;
+    }
+    return res;
+}
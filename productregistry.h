@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Where a product came from: indices into the reactions and molecules of a run.
+// partner is the second monomer of a cross dimer and equals molecule otherwise.
+struct Provenance {
+    unsigned int reaction;
+    unsigned int molecule;
+    unsigned int partner;
+};
+
+// Run-wide set of canonical product keys that can be fed from many threads.
+// The first producer of a key keeps the product, every producer is recorded.
+class ProductRegistry
+{
+public:
+    explicit ProductRegistry(unsigned int shards = 64);
+
+    // True if the key was not seen before in this run
+    bool insert(const std::string &key, unsigned int reaction, unsigned int molecule, unsigned int partner);
+    bool insert(const std::string &key, unsigned int reaction, unsigned int molecule) { return insert(key, reaction, molecule, molecule); }
+
+    std::vector<Provenance> provenance(const std::string &key) const;
+    size_t size() const;
+    size_t duplicates() const;
+
+    // Visits every kept key with all its producers, shard by shard
+    template<typename F>
+    void for_each(F fn) const {
+        for(const auto &shard: m_shards){
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for(const auto &kv: shard.entries){
+                fn(kv.first, kv.second);
+            }
+        }
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::vector<Provenance>> entries;
+        size_t duplicates = 0;
+    };
+
+    Shard &shard(const std::string &key);
+    const Shard &shard(const std::string &key) const;
+
+    std::vector<Shard> m_shards;
+};
@@ -0,0 +1,98 @@
+#include "productstore.h"
+
+#include <GraphMol/MolPickler.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+ProductStore::ProductStore(size_t chunkSize)
+    : m_chunkSize(std::max<size_t>(chunkSize, 1)),
+      m_tail(nullptr),
+      m_capacity(0),
+      m_used(0),
+      m_allocated(0)
+{
+}
+
+size_t ProductStore::append(const std::string &key, const RDKit::ROMol &mol){
+    // Pickling is the expensive part and happens before the lock is taken
+    std::string pickle;
+    RDKit::MolPickler::pickleMol(mol, pickle, RDKit::PicklerOps::MolProps | RDKit::PicklerOps::PrivateProps);
+    size_t needed = key.size() + pickle.size();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_tail || m_used + needed > m_capacity){
+        if(m_chunks.size() >= max_chunks){
+            throw std::length_error("Product store is full");
+        }
+        // A product larger than a chunk gets a chunk of its own
+        m_capacity = std::max(m_chunkSize, needed);
+        m_tail = new char[m_capacity];
+        m_chunks.emplace_back(m_tail, std::default_delete<char[]>());
+        m_used = 0;
+        m_allocated += m_capacity;
+    }
+
+    char *dst = m_tail + m_used;
+    std::memcpy(dst, key.data(), key.size());
+    std::memcpy(dst + key.size(), pickle.data(), pickle.size());
+    m_entries.push_back({m_used, m_chunks.size() - 1, uint32_t(key.size()), uint32_t(pickle.size())});
+    m_used += needed;
+    return m_entries.size() - 1;
+}
+
+size_t ProductStore::adopt(std::shared_ptr<const char> bytes, const std::vector<StoredSpan> &products){
+    for(const auto &p: products){
+        if(p.offset >= max_offset){
+            throw std::length_error("Product offset " + std::to_string(p.offset) + " is too large for the store");
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_chunks.size() >= max_chunks){
+        throw std::length_error("Product store is full");
+    }
+    size_t first = m_entries.size();
+    m_chunks.push_back(std::move(bytes));
+    m_tail = nullptr; // The next append starts a chunk of its own
+    m_entries.reserve(m_entries.size() + products.size());
+    for(const auto &p: products){
+        m_entries.push_back({p.offset, m_chunks.size() - 1, p.keySize, p.pickleSize});
+    }
+    return first;
+}
+
+size_t ProductStore::size() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+const char *ProductStore::locate(size_t index, Entry &entry) const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(index >= m_entries.size()){
+        throw std::out_of_range("No product " + std::to_string(index) + " in the store");
+    }
+    entry = m_entries[index];
+    return m_chunks[entry.chunk].get() + entry.offset;
+}
+
+std::string ProductStore::key(size_t index) const{
+    Entry entry;
+    const char *data = locate(index, entry);
+    return std::string(data, entry.keySize);
+}
+
+std::string ProductStore::pickle(size_t index) const{
+    Entry entry;
+    const char *data = locate(index, entry);
+    return std::string(data + entry.keySize, entry.pickleSize);
+}
+
+RDKit::ROMOL_SPTR ProductStore::molecule(size_t index) const{
+    return RDKit::ROMOL_SPTR(new RDKit::ROMol(pickle(index)));
+}
+
+size_t ProductStore::bytes() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocated + m_entries.capacity() * sizeof(Entry);
+}
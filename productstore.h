@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <GraphMol/GraphMol.h>
+
+// Where a product lies in a block of bytes: its key directly followed by its pickle
+struct StoredSpan {
+    uint64_t offset;
+    uint32_t keySize;
+    uint32_t pickleSize;
+};
+
+// Append-only arena of products kept as RDKit pickles next to their canonical
+// keys. A product costs its pickle and a small index entry instead of a live
+// ROMol; molecules are only rehydrated when they are drawn or exported. Keys
+// and pickles are packed into large chunks that never move once written.
+// Safe to share between threads.
+class ProductStore
+{
+public:
+    explicit ProductStore(size_t chunkSize = size_t(1) << 20);
+
+    ProductStore(const ProductStore &) = delete;
+    ProductStore &operator=(const ProductStore &) = delete;
+
+    // Pickles mol with its private properties and returns the index of the new product
+    size_t append(const std::string &key, const RDKit::ROMol &mol);
+
+    // Takes over products laid out elsewhere, such as in a memory-mapped project
+    // file, without copying them; bytes keeps that memory alive. Returns the
+    // index of the first of them.
+    size_t adopt(std::shared_ptr<const char> bytes, const std::vector<StoredSpan> &products);
+
+    size_t size() const;
+    std::string key(size_t index) const;
+    std::string pickle(size_t index) const;
+
+    // A fresh copy of the product on every call
+    RDKit::ROMOL_SPTR molecule(size_t index) const;
+
+    // Memory allocated by the store itself, adopted bytes are not counted
+    size_t bytes() const;
+
+private:
+    // 16 bytes: up to 2^24 chunks of up to 2^40 bytes each
+    struct Entry {
+        uint64_t offset : 40;
+        uint64_t chunk : 24;
+        uint32_t keySize;
+        uint32_t pickleSize;
+    };
+    static_assert(sizeof(Entry) == 16, "ProductStore::Entry is meant to be 16 bytes");
+    static constexpr uint64_t max_chunks = uint64_t(1) << 24;
+    static constexpr uint64_t max_offset = uint64_t(1) << 40;
+
+    // The entry and the start of its bytes, which stay valid for the life of the store
+    const char *locate(size_t index, Entry &entry) const;
+
+    size_t m_chunkSize;
+    mutable std::mutex m_mutex;
+    std::vector<std::shared_ptr<const char>> m_chunks;
+    char *m_tail;      // Last chunk, if it was allocated here
+    size_t m_capacity; // of the tail chunk
+    size_t m_used;     // Bytes used in the tail chunk
+    size_t m_allocated;
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,210 @@
+#include "productwriter.h"
+#include "depiction.h"
+
+#include <GraphMol/FileParsers/MolWriters.h>
+
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+    bool has_suffix(const std::string &s, const std::string &suffix){
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    bool is_stdout(const std::string &path){
+        return path.empty() || path == "-";
+    }
+
+    void write_tag(std::ostream &out, const std::string &name, const std::string &value){
+        out << ">  <" << name << ">\n" << value << "\n\n";
+    }
+}
+
+ProductWriter::ProductWriter(const std::string &path, size_t capacity)
+    : m_path(path),
+      m_sdf(false),
+      m_capacity(capacity),
+      m_closing(false),
+      m_written(0),
+      m_skipped(0)
+{
+    std::string plain = has_suffix(path, ".gz") ? path.substr(0, path.size() - 3) : path;
+    m_sdf = has_suffix(plain, ".sdf") || has_suffix(plain, ".sd");
+
+    if(is_stdout(path)){
+        m_out.push(std::cout);
+    }
+    else{
+        m_file.open(path, std::ios::binary);
+        if(!m_file){
+            m_error = "Cannot open " + path + " for writing";
+        }
+        if(has_suffix(path, ".gz")){
+            m_out.push(boost::iostreams::gzip_compressor());
+        }
+        m_out.push(m_file);
+    }
+    m_thread = std::thread(&ProductWriter::run, this);
+}
+
+ProductWriter::~ProductWriter(){
+    close();
+}
+
+void ProductWriter::write(ProductEntry entry){
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_space.wait(lock, [this](){
+        return !m_capacity || m_queue.size() < m_capacity || m_closing;
+    });
+    if(m_closing){
+        return;
+    }
+    m_queue.push_back(std::move(entry));
+    m_ready.notify_one();
+}
+
+bool ProductWriter::close(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+        m_ready.notify_one();
+        m_space.notify_all();
+    }
+    if(m_thread.joinable()){
+        m_thread.join();
+    }
+    return ok();
+}
+
+bool ProductWriter::ok() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error.empty();
+}
+
+std::string ProductWriter::error() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+size_t ProductWriter::written() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_written;
+}
+
+size_t ProductWriter::skipped() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_skipped;
+}
+
+std::string ProductWriter::skip_reason() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_skipReason;
+}
+
+void ProductWriter::set_error(const std::string &message){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_error.empty()){
+        m_error = message;
+    }
+}
+
+void ProductWriter::run(){
+    bool failed = !ok();
+    while(true){
+        std::deque<ProductEntry> batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_ready.wait(lock, [this](){
+                return !m_queue.empty() || m_closing;
+            });
+            if(m_queue.empty()){
+                break;
+            }
+            batch.swap(m_queue);
+            m_space.notify_all();
+        }
+
+        // After an error the queue is still drained so producers never block
+        if(failed){
+            continue;
+        }
+        // A product that cannot be written is skipped, only a failing stream stops the writer
+        size_t written = 0, skipped = 0;
+        std::string reason;
+        for(const auto &entry: batch){
+            try{
+                write_entry(entry);
+                written ++;
+            }
+            catch(const std::exception &e){
+                if(!m_out){
+                    break;
+                }
+                if(reason.empty()){
+                    reason = entry.smiles + ": " + e.what();
+                }
+                skipped ++;
+            }
+        }
+        if(!m_out){
+            set_error("Cannot write to " + m_path);
+            failed = true;
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_written += written;
+        m_skipped += skipped;
+        if(m_skipReason.empty()){
+            m_skipReason = reason;
+        }
+    }
+
+    try{
+        m_out.reset(); // Flushes the gzip trailer before the file is closed
+    }
+    catch(const std::exception &e){
+        set_error(e.what());
+    }
+    if(m_file.is_open()){
+        m_file.close();
+        if(m_file.fail()){
+            set_error("Cannot write to " + m_path);
+        }
+    }
+}
+
+void ProductWriter::write_entry(const ProductEntry &entry){
+    std::ostream &out = m_out;
+    if(!m_sdf){
+        out << entry.smiles << "\t" << entry.monomer << "\t" << entry.reaction << "\n";
+        return;
+    }
+
+    // The shared product is never modified, coordinates go on a copy. The record is
+    // built aside and written in one piece, so a product failing halfway leaves nothing
+    RDKit::ROMOL_SPTR source = entry.mol ? entry.mol : RDKit::ROMOL_SPTR(new RDKit::ROMol(entry.pickle));
+    RDKit::ROMOL_SPTR mol = source;
+    if(!mol->getNumConformers()){
+        mol = prepare_depiction(*mol);
+    }
+    RDKit::RWMol record(*mol);
+    record.setProp("_Name", entry.smiles);
+    std::ostringstream text;
+    text << RDKit::MolToMolBlock(record);
+
+    unsigned int site, length;
+    write_tag(text, "reaction", entry.reaction);
+    write_tag(text, "monomer", entry.monomer);
+    if(source->getPropIfPresent("_site", site)){
+        write_tag(text, "site", std::to_string(site + 1));
+    }
+    if(source->getPropIfPresent("_length", length)){
+        write_tag(text, "length", std::to_string(length));
+    }
+    write_tag(text, "smiles", entry.smiles);
+    text << "$$$$\n";
+    out << text.str();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include <GraphMol/GraphMol.h>
+
+#include <boost/iostreams/filtering_stream.hpp>
+
+// A product with where it came from, as it is handed to a ProductWriter
+struct ProductEntry {
+    std::string smiles;
+    RDKit::ROMOL_SPTR mol;
+    std::string reaction;
+    std::string monomer;
+    std::string pickle; // Rehydrated by the writer when mol is null
+};
+
+// Streams products into a single file from a background thread. The format is
+// chosen by extension: .sdf/.sd gets one record per product with the reaction,
+// monomer, reacting site and oligomer length as SD tags, anything else gets SMILES lines
+// "SMILES<TAB>monomer<TAB>reaction". A trailing .gz compresses the output.
+// An empty path or "-" writes SMILES lines to stdout.
+class ProductWriter
+{
+public:
+    // Producers block in write() while capacity entries are waiting, 0 never blocks
+    explicit ProductWriter(const std::string &path, size_t capacity = 4096);
+    ~ProductWriter();
+
+    ProductWriter(const ProductWriter &) = delete;
+    ProductWriter &operator=(const ProductWriter &) = delete;
+
+    // Safe to call from any thread, entries are written in the order they arrive
+    void write(ProductEntry entry);
+
+    // The file is opened by the constructor, so ok() already tells if it failed.
+    // Writes what is still queued and closes the file. Returns false if the file
+    // could not be opened or written, error() then says why.
+    bool close();
+
+    bool ok() const;
+    std::string error() const;
+    size_t written() const;
+    // Products whose record could not be made, e.g. a pickle that does not load,
+    // and why the first of them failed
+    size_t skipped() const;
+    std::string skip_reason() const;
+
+private:
+    void run();
+    void write_entry(const ProductEntry &entry);
+    void set_error(const std::string &message);
+
+    std::string m_path;
+    bool m_sdf;
+    size_t m_capacity;
+    std::ofstream m_file;
+    boost::iostreams::filtering_ostream m_out;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_ready, m_space;
+    std::deque<ProductEntry> m_queue;
+    bool m_closing;
+    std::string m_error;
+    size_t m_written;
+    size_t m_skipped;
+    std::string m_skipReason;
+    std::thread m_thread;
+};
@@ -0,0 +1,341 @@
+#include "projectfile.h"
+
+#include <GraphMol/MolPickler.h>
+#include <GraphMol/ChemReactions/ReactionPickler.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    const char magic[4] = {'D', 'G', 'P', 'J'};
+    const uint32_t format_version = 1;
+
+    enum Section : uint32_t {
+        Molecules = 1,
+        Reactions,
+        Products,
+        ProvenanceSection,
+        RunReactions,
+        RunMolecules
+    };
+
+    const size_t header_size = 16;
+    const size_t section_entry_size = 24;
+    const size_t table_entry_size = 16;
+    const size_t provenance_size = 12;
+
+    template<typename T>
+    void put(std::string &out, T value){
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    T get(const char *p){
+        T value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    void pad(std::string &out){
+        out.append((8 - out.size() % 8) % 8, '\0');
+    }
+
+    std::string pickle_molecule(const RDKit::ROMol &mol){
+        std::string pickle;
+        RDKit::MolPickler::pickleMol(mol, pickle, RDKit::PicklerOps::MolProps | RDKit::PicklerOps::PrivateProps);
+        return pickle;
+    }
+}
+
+void ProjectWriter::Table::add(const std::string &key, const std::string &data){
+    index.push_back({blob.size(), uint32_t(key.size()), uint32_t(data.size())});
+    blob += key;
+    blob += data;
+}
+
+std::string ProjectWriter::Table::serialize() const{
+    std::string res;
+    res.reserve(8 + index.size() * table_entry_size + blob.size());
+    put<uint64_t>(res, index.size());
+    for(const auto &e: index){
+        put<uint64_t>(res, e.offset);
+        put<uint32_t>(res, e.keySize);
+        put<uint32_t>(res, e.pickleSize);
+    }
+    res += blob;
+    return res;
+}
+
+void ProjectWriter::add_molecule(const std::string &name, const std::string &pickle){
+    m_molecules.add(name, pickle);
+}
+
+void ProjectWriter::add_molecule(const std::string &name, const RDKit::ROMol &mol){
+    m_molecules.add(name, pickle_molecule(mol));
+}
+
+void ProjectWriter::add_reaction(const std::string &name, const RDKit::ChemicalReaction &rxn){
+    std::string pickle;
+    RDKit::ReactionPickler::pickleReaction(rxn, pickle);
+    m_reactions.add(name, pickle);
+}
+
+void ProjectWriter::add_product(const std::string &key, const std::string &pickle, const std::vector<Provenance> &producers){
+    m_products.add(key, pickle);
+    m_provenance.insert(m_provenance.end(), producers.begin(), producers.end());
+    m_provenanceOffsets.push_back(m_provenance.size());
+}
+
+void ProjectWriter::set_run_names(const std::vector<std::string> &reactions, const std::vector<std::string> &molecules){
+    m_runReactions = Table();
+    m_runMolecules = Table();
+    for(const auto &r: reactions){
+        m_runReactions.add(r, "");
+    }
+    for(const auto &m: molecules){
+        m_runMolecules.add(m, "");
+    }
+}
+
+bool ProjectWriter::write(const std::string &path){
+    std::string provenance;
+    put<uint64_t>(provenance, m_provenanceOffsets.size() - 1);
+    for(auto offset: m_provenanceOffsets){
+        put<uint64_t>(provenance, offset);
+    }
+    for(const auto &p: m_provenance){
+        put<uint32_t>(provenance, p.reaction);
+        put<uint32_t>(provenance, p.molecule);
+        put<uint32_t>(provenance, p.partner);
+    }
+
+    std::vector<std::pair<uint32_t, std::string>> sections;
+    sections.emplace_back(Molecules, m_molecules.serialize());
+    sections.emplace_back(Reactions, m_reactions.serialize());
+    sections.emplace_back(Products, m_products.serialize());
+    sections.emplace_back(ProvenanceSection, std::move(provenance));
+    sections.emplace_back(RunReactions, m_runReactions.serialize());
+    sections.emplace_back(RunMolecules, m_runMolecules.serialize());
+
+    std::string header(magic, sizeof(magic));
+    put<uint32_t>(header, format_version);
+    put<uint32_t>(header, sections.size());
+    put<uint32_t>(header, 0);
+    uint64_t offset = header_size + sections.size() * section_entry_size;
+    for(const auto &s: sections){
+        offset += (8 - offset % 8) % 8;
+        put<uint32_t>(header, s.first);
+        put<uint32_t>(header, 0);
+        put<uint64_t>(header, offset);
+        put<uint64_t>(header, s.second.size());
+        offset += s.second.size();
+    }
+
+    std::filesystem::path tmp = path + ".tmp";
+    std::error_code ec;
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        pad(header);
+        out.write(header.data(), header.size());
+        size_t written = header.size();
+        for(const auto &s: sections){
+            std::string padding((8 - written % 8) % 8, '\0');
+            out.write(padding.data(), padding.size());
+            out.write(s.second.data(), s.second.size());
+            written += padding.size() + s.second.size();
+        }
+        if(!out.flush()){
+            m_error = "Cannot write to " + tmp.string();
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if(ec){
+        m_error = "Cannot replace " + path + ": " + ec.message();
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+StoredSpan ProjectReader::Table::span(size_t i) const{
+    const char *e = index + i * table_entry_size;
+    return {get<uint64_t>(e), get<uint32_t>(e + 8), get<uint32_t>(e + 12)};
+}
+
+std::string ProjectReader::Table::key(size_t i) const{
+    StoredSpan s = span(i);
+    return std::string(blob + s.offset, s.keySize);
+}
+
+std::string ProjectReader::Table::data(size_t i) const{
+    StoredSpan s = span(i);
+    return std::string(blob + s.offset + s.keySize, s.pickleSize);
+}
+
+bool ProjectReader::read_table(const char *data, uint64_t size, Table &table){
+    if(size < 8){
+        return false;
+    }
+    table.count = get<uint64_t>(data);
+    if(table.count > (size - 8) / table_entry_size){
+        return false;
+    }
+    table.index = data + 8;
+    table.blob = table.index + table.count * table_entry_size;
+    table.blobSize = size - 8 - table.count * table_entry_size;
+    // Every record is checked once here, so the accessors can trust the index
+    for(size_t i = 0; i < table.count; i ++){
+        StoredSpan s = table.span(i);
+        if(s.offset > table.blobSize || uint64_t(s.keySize) + s.pickleSize > table.blobSize - s.offset){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProjectReader::open(const std::string &path){
+    *this = ProjectReader();
+    auto file = std::make_shared<boost::iostreams::mapped_file_source>();
+    try{
+        file->open(path);
+    }
+    catch(const std::exception &e){
+        m_error = "Cannot open " + path + ": " + e.what();
+        return false;
+    }
+    if(!file->is_open()){
+        m_error = "Cannot open " + path;
+        return false;
+    }
+
+    const char *base = file->data();
+    uint64_t size = file->size();
+    m_mapping = std::shared_ptr<const char>(file, base);
+
+    if(size < header_size || !std::equal(magic, magic + 4, base) || get<uint32_t>(base + 4) != format_version){
+        m_error = path + " is not a project file of this version";
+        return false;
+    }
+    uint32_t numSections = get<uint32_t>(base + 8);
+    if(numSections > (size - header_size) / section_entry_size){
+        m_error = path + " is truncated";
+        return false;
+    }
+
+    bool valid = true;
+    for(uint32_t i = 0; i < numSections && valid; i ++){
+        const char *entry = base + header_size + i * section_entry_size;
+        uint32_t id = get<uint32_t>(entry);
+        uint64_t offset = get<uint64_t>(entry + 8);
+        uint64_t length = get<uint64_t>(entry + 16);
+        if(offset > size || length > size - offset){
+            valid = false;
+            break;
+        }
+        const char *data = base + offset;
+        switch(id){
+        case Molecules: valid = read_table(data, length, m_molecules); break;
+        case Reactions: valid = read_table(data, length, m_reactions); break;
+        case Products: valid = read_table(data, length, m_products); break;
+        case RunReactions: valid = read_table(data, length, m_runReactions); break;
+        case RunMolecules: valid = read_table(data, length, m_runMolecules); break;
+        case ProvenanceSection:{
+            uint64_t count = length >= 8 ? get<uint64_t>(data) : 0;
+            valid = length >= 8 && count < (length - 8) / 8;
+            if(valid){
+                m_provenanceProducts = count;
+                m_provenanceOffsets = data + 8;
+                m_provenance = m_provenanceOffsets + (count + 1) * 8;
+                m_provenanceCount = (length - 8 - (count + 1) * 8) / provenance_size;
+                valid = get<uint64_t>(m_provenanceOffsets + count * 8) <= m_provenanceCount;
+            }
+            break;
+        }
+        default: break; // Sections of later versions are skipped
+        }
+    }
+    if(!valid){
+        m_error = path + " is damaged";
+        return false;
+    }
+    return true;
+}
+
+std::string ProjectReader::molecule_name(size_t i) const{
+    return m_molecules.key(i);
+}
+
+RDKit::ROMOL_SPTR ProjectReader::molecule(size_t i) const{
+    return RDKit::ROMOL_SPTR(new RDKit::ROMol(m_molecules.data(i)));
+}
+
+std::string ProjectReader::reaction_name(size_t i) const{
+    return m_reactions.key(i);
+}
+
+RXN_SPTR ProjectReader::reaction(size_t i) const{
+    RXN_SPTR rxn(new RDKit::ChemicalReaction(m_reactions.data(i)));
+    rxn->initReactantMatchers();
+    return rxn;
+}
+
+std::vector<Provenance> ProjectReader::provenance(size_t product) const{
+    std::vector<Provenance> res;
+    if(product >= m_provenanceProducts){
+        return res;
+    }
+    uint64_t first = get<uint64_t>(m_provenanceOffsets + product * 8);
+    uint64_t last = get<uint64_t>(m_provenanceOffsets + (product + 1) * 8);
+    for(uint64_t i = first; i < last && i < m_provenanceCount; i ++){
+        const char *p = m_provenance + i * provenance_size;
+        res.push_back({get<uint32_t>(p), get<uint32_t>(p + 4), get<uint32_t>(p + 8)});
+    }
+    return res;
+}
+
+std::vector<std::string> ProjectReader::run_reaction_names() const{
+    std::vector<std::string> res;
+    for(size_t i = 0; i < m_runReactions.count; i ++){
+        res.push_back(m_runReactions.key(i));
+    }
+    return res;
+}
+
+std::vector<std::string> ProjectReader::run_molecule_names() const{
+    std::vector<std::string> res;
+    for(size_t i = 0; i < m_runMolecules.count; i ++){
+        res.push_back(m_runMolecules.key(i));
+    }
+    return res;
+}
+
+size_t ProjectReader::adopt(const Table &table, ProductStore &store) const{
+    std::vector<StoredSpan> spans(table.count);
+    for(size_t i = 0; i < table.count; i ++){
+        spans[i] = table.span(i);
+    }
+    // Aliases the mapping, which then lives as long as the store needs it
+    return store.adopt(std::shared_ptr<const char>(m_mapping, table.blob), spans);
+}
+
+size_t ProjectReader::adopt_molecules(ProductStore &store) const{
+    return adopt(m_molecules, store);
+}
+
+size_t ProjectReader::adopt_products(ProductStore &store) const{
+    return adopt(m_products, store);
+}
+
+void ProjectReader::fill_registry(ProductRegistry &registry) const{
+    for(size_t i = 0; i < m_products.count; i ++){
+        std::string key = m_products.key(i);
+        for(const auto &p: provenance(i)){
+            registry.insert(key, p.reaction, p.molecule, p.partner);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GraphMol/GraphMol.h>
+
+#include "productregistry.h"
+#include "productstore.h"
+#include "reactionengine.h"
+
+// Single-file snapshot of a session: the input molecules and compiled reactions,
+// and the deduplicated products of the last run with their provenance. Molecules
+// and reactions are kept as RDKit pickles, so nothing is parsed again on load.
+//
+// The file is a header with a table of sections followed by the sections, each
+// aligned to 8 bytes. Molecules, reactions and products are tables: a count,
+// one {offset, key size, data size} entry per record and a blob in which every
+// record is its key followed by its data, the layout a ProductStore uses. A
+// reader maps the file and hands those blobs to ProductStores as they are.
+
+class ProjectWriter
+{
+public:
+    ProjectWriter() = default;
+
+    void add_molecule(const std::string &name, const std::string &pickle);
+    void add_molecule(const std::string &name, const RDKit::ROMol &mol);
+    void add_reaction(const std::string &name, const RDKit::ChemicalReaction &rxn);
+    void add_product(const std::string &key, const std::string &pickle, const std::vector<Provenance> &producers);
+
+    // Names the provenance indices of the products refer to
+    void set_run_names(const std::vector<std::string> &reactions, const std::vector<std::string> &molecules);
+
+    // Written aside and renamed, so an existing project is only replaced by a complete one
+    bool write(const std::string &path);
+    const std::string &error() const { return m_error; }
+
+private:
+    struct Table {
+        std::vector<StoredSpan> index;
+        std::string blob;
+
+        void add(const std::string &key, const std::string &data);
+        std::string serialize() const;
+    };
+
+    Table m_molecules, m_reactions, m_products, m_runReactions, m_runMolecules;
+    std::vector<uint64_t> m_provenanceOffsets{0};
+    std::vector<Provenance> m_provenance;
+    std::string m_error;
+};
+
+class ProjectReader
+{
+public:
+    ProjectReader() = default;
+
+    // Maps the file, records are only read when they are asked for
+    bool open(const std::string &path);
+    const std::string &error() const { return m_error; }
+
+    size_t molecules() const { return m_molecules.count; }
+    size_t reactions() const { return m_reactions.count; }
+    size_t products() const { return m_products.count; }
+
+    std::string molecule_name(size_t i) const;
+    RDKit::ROMOL_SPTR molecule(size_t i) const;
+    std::string reaction_name(size_t i) const;
+    RXN_SPTR reaction(size_t i) const;
+    std::vector<Provenance> provenance(size_t product) const;
+    std::vector<std::string> run_reaction_names() const;
+    std::vector<std::string> run_molecule_names() const;
+
+    // Appends every molecule or product to store without copying them; the
+    // store keeps the mapping alive after the reader is gone
+    size_t adopt_molecules(ProductStore &store) const;
+    size_t adopt_products(ProductStore &store) const;
+
+    // Rebuilds the provenance of every product
+    void fill_registry(ProductRegistry &registry) const;
+
+private:
+    struct Table {
+        const char *blob = nullptr;
+        const char *index = nullptr;
+        uint64_t count = 0;
+        uint64_t blobSize = 0;
+
+        StoredSpan span(size_t i) const;
+        std::string key(size_t i) const;
+        std::string data(size_t i) const;
+    };
+
+    bool read_table(const char *data, uint64_t size, Table &table);
+    size_t adopt(const Table &table, ProductStore &store) const;
+
+    std::shared_ptr<const char> m_mapping; // Start of the mapped file, keeps it mapped
+    Table m_molecules, m_reactions, m_products, m_runReactions, m_runMolecules;
+    const char *m_provenanceOffsets = nullptr;
+    const char *m_provenance = nullptr;
+    uint64_t m_provenanceProducts = 0, m_provenanceCount = 0;
+    std::string m_error;
+};
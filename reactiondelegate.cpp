@@ -0,0 +1,26 @@
+#include "reactiondelegate.h"
+#include "reactionmodel.h"
+
+#include <GraphMol/MolDraw2D/Qt/MolDraw2DQt.h>
+
+ReactionDelegate::ReactionDelegate(QObject *parent)
+    : StructureDelegate{parent}
+{
+}
+
+bool ReactionDelegate::structure(const QModelIndex &index, Structure &s) const{
+    const ReactionModel *model = qobject_cast<const ReactionModel*>(index.model());
+    if(!model){
+        return false;
+    }
+    const LibraryReaction &r = model->reaction(index.row());
+    if(r.rxn){
+        RXN_SPTR rxn = r.rxn;
+        s.identity = rxn.get();
+        s.name = QString::fromStdString(r.name);
+        s.draw = [rxn](RDKit::MolDraw2DQt &drawer){
+            drawer.drawReaction(*rxn);
+        };
+    }
+    return true;
+}
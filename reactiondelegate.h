@@ -0,0 +1,15 @@
+#pragma once
+
+#include "structuredelegate.h"
+
+// Draws the reaction of a ReactionModel row with its name underneath
+class ReactionDelegate : public StructureDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit ReactionDelegate(QObject *parent = nullptr);
+
+protected:
+    bool structure(const QModelIndex &index, Structure &s) const override;
+};
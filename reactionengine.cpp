@@ -0,0 +1,563 @@
+#include "reactionengine.h"
+#include "parallel.h"
+#include "instrumentation.h"
+
+#include <GraphMol/SmilesParse/SmilesParse.h>
+#include <GraphMol/SmilesParse/SmilesWrite.h>
+#include <GraphMol/SmilesParse/SmartsWrite.h>
+
+#include <GraphMol/ChemReactions/ReactionParser.h>
+
+#include <GraphMol/new_canon.h>
+#include <GraphMol/SanitException.h>
+#include <GraphMol/PeriodicTable.h>
+#include <GraphMol/Substruct/SubstructMatch.h>
+
+#include <GraphMol/ChemTransforms/MolFragmenter.h>
+#include <GraphMol/MolStandardize/Fragment.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+    struct BridgeFragment {
+        std::string smiles; // Attachment points are still labelled, e.g. [12*]
+        std::string key;    // Canonical SMILES with anonymous attachment points
+    };
+
+    // idx1 and idx2 are C-H bonds of the hydrogen-complete molecule hmol
+    BridgeFragment cut_bridge(const RDKit::ROMol &hmol, const unsigned int idx1, const unsigned int idx2){
+        RDKit::ROMOL_SPTR r;
+        RDKit::ROMOL_SPTR fragments(RDKit::MolFragmenter::fragmentOnBonds(hmol, RDKit::UINT_VECT({idx1,idx2})));
+        RDKit::MolStandardize::LargestFragmentChooser neZnam;
+        r.reset(neZnam.choose(*fragments));
+
+        RDKit::ROMOL_SPTR stripped(RDKit::MolOps::removeAllHs(*r));
+        RDKit::RWMol frag(*stripped);
+
+        BridgeFragment res;
+        res.smiles = RDKit::MolToSmiles(frag);
+        for(auto atom: frag.atoms()){
+            if(atom->getAtomicNum() == 0){
+                atom->setIsotope(0);
+            }
+        }
+        res.key = RDKit::MolToSmiles(frag);
+        return res;
+    }
+
+    RXN_SPTR fragment_to_reaction(const BridgeFragment &fragment, const unsigned int idx1, const unsigned int idx2){
+        //Create reaction SMARTS
+        std::string idx1_name = "[" + std::to_string(idx1) + "*]";
+        std::string idx2_name = "[" + std::to_string(idx2) + "*]";
+
+        std::string smarts = fragment.smiles;
+        smarts.replace(smarts.find(idx1_name), idx1_name.size(), "[cH1:1]");
+        smarts.replace(smarts.find(idx2_name), idx2_name.size(), "[cH1:2]");
+        smarts = "([cH1:1]).([cH1:2])>>" + smarts;
+
+        RXN_SPTR react(RDKit::RxnSmartsToChemicalReaction(smarts));
+        react->initReactantMatchers();
+
+        return react;
+    }
+
+    // Index of the only C-H bond of every heavy atom of a hydrogen-complete molecule, -1 if there is none or several
+    std::vector<int> hydrogen_bonds(const RDKit::ROMol &mol, const unsigned int numHeavyAtoms){
+        std::vector<int> res(numHeavyAtoms, -1);
+        for(unsigned int Cidx = 0; Cidx < numHeavyAtoms; Cidx ++){
+            const RDKit::Atom *carbon = mol.getAtomWithIdx(Cidx);
+            int Hidx = -1;
+            for(const auto &nbri: make_iterator_range(mol.getAtomBonds(carbon))){
+                const RDKit::Bond *bond = mol[nbri];
+                if(bond->getOtherAtom(carbon)->getAtomicNum() == 1){
+                    if(Hidx == -1){
+                        Hidx = bond->getIdx();
+                    }
+                    else{
+                        Hidx = -1;
+                        break;
+                    }
+                }
+            }
+            res[Cidx] = Hidx;
+        }
+        return res;
+    }
+
+    // Atom permutations mapping the molecule onto itself, perm[i] is the image of atom i
+    std::vector<RDKit::UINT_VECT> automorphisms(const RDKit::ROMol &mol){
+        RDKit::SubstructMatchParameters params;
+        params.uniquify = false;
+        params.maxMatches = std::numeric_limits<unsigned int>::max();
+
+        std::vector<RDKit::UINT_VECT> res;
+        for(const auto &match: RDKit::SubstructMatch(mol, mol, params)){
+            RDKit::UINT_VECT perm(mol.getNumAtoms());
+            for(const auto &p: match){
+                perm[p.first] = p.second;
+            }
+            res.push_back(std::move(perm));
+        }
+        return res;
+    }
+
+    // Checks that need neither sanitization nor ring perception, cheapest first
+    bool passes_raw(const RDKit::ROMol &mol, const ProductFilter &filter){
+        if(filter.maxHeavyAtoms && mol.getNumHeavyAtoms() > filter.maxHeavyAtoms){
+            RunStats::reject(Rejection::HeavyAtoms);
+            return false;
+        }
+        if(filter.maxRings){
+            // Number of independent cycles of the molecular graph, the size of the SSSR
+            std::vector<int> frags;
+            unsigned int numFrags = RDKit::MolOps::getMolFrags(mol, frags);
+            unsigned int rings = mol.getNumBonds() + numFrags - mol.getNumAtoms();
+            if(rings > filter.maxRings){
+                RunStats::reject(Rejection::Rings);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Average molecular weight, implicit hydrogens included; needs a sanitized molecule
+    double mol_wt(const RDKit::ROMol &mol){
+        const RDKit::PeriodicTable *table = RDKit::PeriodicTable::getTable();
+        double hydrogen = table->getAtomicWeight(1);
+        double res = 0;
+        for(const auto atom: mol.atoms()){
+            res += atom->getMass() + atom->getTotalNumHs() * hydrogen;
+        }
+        return res;
+    }
+
+    // Sanitizes, filters and canonicalizes the first product of every runReactants outcome
+    std::vector<Product> sanitized_products(std::vector<RDKit::MOL_SPTR_VECT> &products, const unsigned int site, const ProductFilter *filter){
+        std::vector<Product> res;
+        res.reserve(products.size());
+        for(auto &p: products){
+            // Reaction products are RWMols, sanitize them where they are instead of going through SMILES
+            RDKit::RWMOL_SPTR mol = boost::dynamic_pointer_cast<RDKit::RWMol>(p[0]);
+            if(!mol){
+                mol.reset(new RDKit::RWMol(*p[0]));
+            }
+            if(filter && !passes_raw(*mol, *filter)){
+                continue;
+            }
+            try{
+                StageTimer timer(Stage::Sanitize);
+                RDKit::MolOps::sanitizeMol(*mol);
+            }
+            catch(const RDKit::MolSanitizeException &){
+                RunStats::reject(Rejection::Sanitize);
+                continue;
+            }
+            if(filter && filter->maxMolWt > 0 && mol_wt(*mol) > filter->maxMolWt){
+                RunStats::reject(Rejection::MolWt);
+                continue;
+            }
+            mol->setProp("_site", site); // Private property, kept for the provenance of exported products
+            StageTimer timer(Stage::Canonicalize);
+            res.push_back({RDKit::MolToSmiles(*mol), mol});
+        }
+        return res;
+    }
+
+    std::string get_reaction_key(RXN_SPTR react){
+        static const PREPARED_SPTR benzene = prepare_reactant(RDKit::ROMOL_SPTR(RDKit::SmilesToMol("C1=CC=CC=C1")));
+        auto product = run_reaction_with_symm(react, *benzene);
+        if(product.empty()){
+            return "";
+        }
+        return product.begin()->first; // There should be only one product
+    }
+}
+
+bool BridgeKeyCache::find(const std::string &fragment, std::string &key) const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_keys.find(fragment);
+    if(it == m_keys.end()){
+        return false;
+    }
+    key = it->second;
+    return true;
+}
+
+void BridgeKeyCache::insert(const std::string &fragment, const std::string &key){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_keys.insert(std::make_pair(fragment, key));
+}
+
+size_t BridgeKeyCache::size() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_keys.size();
+}
+
+RXN_SPTR mol_to_reaction(const RDKit::ROMOL_SPTR mol, const unsigned int idx1, const unsigned int idx2){
+    RDKit::ROMOL_SPTR hmol(RDKit::MolOps::addHs(*mol));
+    return fragment_to_reaction(cut_bridge(*hmol, idx1, idx2), idx1, idx2);
+}
+
+PREPARED_SPTR prepare_reactant(RDKit::ROMOL_SPTR mol){
+    StageTimer timer(Stage::Prepare);
+    std::shared_ptr<PreparedReactant> res(new PreparedReactant);
+    res->mol = mol;
+    res->reactant = protected_reactant(*mol);
+    res->smiles = RDKit::MolToSmiles(*res->reactant);
+    RDKit::Canon::rankMolAtoms(*res->reactant, res->ranks, false);
+
+    std::unordered_map<RDKit::UINT, unsigned int> classIdx;
+    for(unsigned int i = 0; i < res->ranks.size(); i ++){
+        auto it = classIdx.insert(std::make_pair(res->ranks[i], res->classes.size()));
+        if(it.second){
+            res->classes.push_back({});
+            res->sites.push_back(i);
+        }
+        res->classes[it.first->second].push_back(i);
+    }
+    return res;
+}
+
+RDKit::UINT_VECT unique_atoms(RDKit::ROMOL_SPTR mol){
+    RDKit::UINT_VECT rank;
+    RDKit::Canon::rankMolAtoms(*mol, rank, false);
+
+    std::unordered_map<RDKit::UINT, int> uniqueIds;
+    for(unsigned int i = 0; i < rank.size(); i ++){
+        uniqueIds.insert(std::make_pair(rank[i], i));
+    }
+
+    RDKit::UINT_VECT result;
+    for(auto &kv: uniqueIds){
+        result.push_back(kv.second);
+    }
+
+    return result;
+}
+
+RDKit::ROMOL_SPTR protected_reactant(const RDKit::ROMol &mol){
+    RDKit::ROMOL_SPTR res(RDKit::MolOps::removeAllHs(mol));
+    for(auto atom: res->atoms()){
+        atom->setProp("_protected", "1");
+    }
+    return res;
+}
+
+std::string ProductFilter::key() const{
+    if(empty()){
+        return "";
+    }
+    return "heavy<=" + std::to_string(maxHeavyAtoms) + " rings<=" + std::to_string(maxRings) + " mw<=" + std::to_string(maxMolWt);
+}
+
+std::vector<Product> run_reaction_at_site(RXN_SPTR rxn, const RDKit::ROMol &reactant, const unsigned int site, const ProductFilter *filter){
+    // The site is opened on a private copy, so the shared reactant stays read-only
+    RDKit::ROMOL_SPTR open(new RDKit::ROMol(reactant));
+    open->getAtomWithIdx(site)->clearProp("_protected");
+
+    RDKit::MOL_SPTR_VECT rVect = {open, open};
+    std::vector<RDKit::MOL_SPTR_VECT> products;
+    {
+        StageTimer timer(Stage::RunReactants);
+        products = rxn->runReactants(rVect);
+    }
+
+    return sanitized_products(products, site, filter);
+}
+
+RDKit::UINT_VECT reactive_sites(RXN_SPTR rxn, const PreparedReactant &mol){
+    StageTimer timer(Stage::Match);
+    unsigned int numAtoms = mol.reactant->getNumAtoms();
+    std::vector<bool> matched(numAtoms, true);
+
+    RDKit::SubstructMatchParameters params;
+    params.uniquify = false;
+    params.maxMatches = numAtoms;
+    for(const auto &tmpl: rxn->getReactants()){
+        // Only the site is left unprotected, so a template spanning more atoms never matches
+        if(tmpl->getNumAtoms() != 1){
+            return {};
+        }
+
+        std::vector<bool> hit(numAtoms, false);
+        for(const auto &match: RDKit::SubstructMatch(*mol.reactant, *tmpl, params)){
+            hit[match[0].second] = true;
+        }
+        for(unsigned int i = 0; i < numAtoms; i ++){
+            matched[i] = matched[i] && hit[i];
+        }
+    }
+
+    RDKit::UINT_VECT res;
+    for(auto site: mol.sites){
+        if(matched[site]){
+            res.push_back(site);
+        }
+    }
+    return res;
+}
+
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_reaction_with_symm(RXN_SPTR rxn, const PreparedReactant &mol, const int expected_molecules, const ProductFilter *filter){
+    std::unordered_map<std::string, RDKit::ROMOL_SPTR> product; // The final reaction products
+    product.reserve(expected_molecules);
+
+    // Both reactants react through the same site, so each reactive site gives a single product
+    for(auto uId: reactive_sites(rxn, mol)){
+        for(auto &p: run_reaction_at_site(rxn, *mol.reactant, uId, filter)){
+            StageTimer timer(Stage::Dedupe);
+            product.insert(std::make_pair(std::move(p.smiles), p.mol)); // Removes the duplicates if there are any
+        }
+    }
+    return product;
+}
+
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_reaction_with_symm(RXN_SPTR rxn, RDKit::ROMOL_SPTR mol, const int expected_molecules){
+    return run_reaction_with_symm(rxn, *prepare_reactant(mol), expected_molecules);
+}
+
+RDKit::UINT_VECT reactive_sites(RXN_SPTR rxn, const PreparedReactant &mol, const unsigned int templateIdx){
+    StageTimer timer(Stage::Match);
+    const auto &tmpl = rxn->getReactants().at(templateIdx);
+    if(tmpl->getNumAtoms() != 1){
+        return {};
+    }
+
+    unsigned int numAtoms = mol.reactant->getNumAtoms();
+    RDKit::SubstructMatchParameters params;
+    params.uniquify = false;
+    params.maxMatches = numAtoms;
+    std::vector<bool> hit(numAtoms, false);
+    for(const auto &match: RDKit::SubstructMatch(*mol.reactant, *tmpl, params)){
+        hit[match[0].second] = true;
+    }
+
+    RDKit::UINT_VECT res;
+    for(auto site: mol.sites){
+        if(hit[site]){
+            res.push_back(site);
+        }
+    }
+    return res;
+}
+
+bool symmetric_reaction(RXN_SPTR rxn){
+    if(rxn->getNumReactantTemplates() != 2 || rxn->getNumProductTemplates() != 1){
+        return false;
+    }
+    const auto &reactants = rxn->getReactants();
+    if(reactants[0]->getNumAtoms() != 1 || reactants[1]->getNumAtoms() != 1){
+        return false;
+    }
+    int map0 = reactants[0]->getAtomWithIdx(0)->getAtomMapNum();
+    int map1 = reactants[1]->getAtomWithIdx(0)->getAtomMapNum();
+    if(!map0 || !map1){
+        return false;
+    }
+
+    try{
+        // Both templates have to be the same query once their map numbers are gone
+        std::string tmpl[2];
+        for(unsigned int i = 0; i < 2; i ++){
+            RDKit::RWMol t(*reactants[i]);
+            t.getAtomWithIdx(0)->setAtomMapNum(0);
+            tmpl[i] = RDKit::MolToSmarts(t);
+        }
+        if(tmpl[0] != tmpl[1]){
+            return false;
+        }
+
+        // and the product has to look the same from either end
+        RDKit::RWMol product(*rxn->getProducts()[0]), swapped(product);
+        for(auto atom: swapped.atoms()){
+            if(atom->getAtomMapNum() == map0){
+                atom->setAtomMapNum(map1);
+            }
+            else if(atom->getAtomMapNum() == map1){
+                atom->setAtomMapNum(map0);
+            }
+        }
+        return RDKit::MolToSmiles(product) == RDKit::MolToSmiles(swapped);
+    }
+    catch(const std::exception &){
+        return false; // Both orders are then run, which is never wrong
+    }
+}
+
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_reaction_pair(RXN_SPTR rxn, const PreparedReactant &a, const PreparedReactant &b, const ProductFilter *filter, const bool symmetric){
+    std::unordered_map<std::string, RDKit::ROMOL_SPTR> product;
+    if(rxn->getNumReactantTemplates() != 2){
+        return product;
+    }
+
+    // Every reactant is opened once per site it can react through, for either template
+    auto open_sites = [&rxn](const PreparedReactant &mol, const unsigned int templateIdx){
+        std::vector<std::pair<unsigned int, RDKit::ROMOL_SPTR>> res;
+        for(auto site: reactive_sites(rxn, mol, templateIdx)){
+            RDKit::ROMOL_SPTR open(new RDKit::ROMol(*mol.reactant));
+            open->getAtomWithIdx(site)->clearProp("_protected");
+            res.push_back({site, open});
+        }
+        return res;
+    };
+
+    // The two ends of a bridge are not alike, so a takes the first template and then the second one
+    for(unsigned int order = 0; order < (symmetric ? 1 : 2); order ++){
+        auto aSites = open_sites(a, order);
+        auto bSites = open_sites(b, 1 - order);
+        for(const auto &sa: aSites){
+            for(const auto &sb: bSites){
+                RDKit::MOL_SPTR_VECT rVect = order ? RDKit::MOL_SPTR_VECT{sb.second, sa.second} : RDKit::MOL_SPTR_VECT{sa.second, sb.second};
+                std::vector<RDKit::MOL_SPTR_VECT> products;
+                {
+                    StageTimer timer(Stage::RunReactants);
+                    products = rxn->runReactants(rVect);
+                }
+                for(auto &p: sanitized_products(products, sa.first, filter)){
+                    StageTimer timer(Stage::Dedupe);
+                    product.insert(std::make_pair(std::move(p.smiles), p.mol));
+                }
+            }
+        }
+    }
+    return product;
+}
+
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_cross_pair(RXN_SPTR rxn, const PreparedReactant &a, const PreparedReactant &b, const bool symmetric, const ProductFilter *filter){
+    if(&a == &b){
+        return run_reaction_with_symm(rxn, a, 128, filter);
+    }
+    return run_reaction_pair(rxn, a, b, filter, symmetric);
+}
+
+std::string OligomerOptions::key() const{
+    if(maxLength <= 2){
+        return "";
+    }
+    return "length<=" + std::to_string(maxLength) + " frontier<=" + std::to_string(maxFrontier);
+}
+
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> generate_oligomers(RXN_SPTR rxn, const PreparedReactant &monomer, const OligomerOptions &options, const ProductFilter *filter){
+    std::unordered_map<std::string, RDKit::ROMOL_SPTR> res = run_reaction_with_symm(rxn, monomer, 128, filter);
+    std::vector<std::string> frontier;
+    for(auto &p: res){
+        p.second->setProp("_length", 2u);
+        frontier.push_back(p.first);
+    }
+
+    // res doubles as the visited set: an oligomer reached again through another path is not expanded twice
+    RunStats *stats = RunStats::current();
+    bool symmetric = symmetric_reaction(rxn);
+    for(unsigned int length = 3; length <= options.maxLength && !frontier.empty(); length ++){
+        // Sorted so that truncation and the merge below do not depend on hashing
+        std::sort(frontier.begin(), frontier.end());
+        if(options.maxFrontier && frontier.size() > options.maxFrontier){
+            frontier.resize(options.maxFrontier);
+        }
+
+        const auto &visited = res;
+        std::vector<std::unordered_map<std::string, RDKit::ROMOL_SPTR>> expanded(frontier.size());
+        parallel_for(frontier.size(), [&](size_t i){
+            RunStats::Scope scope(stats);
+            PREPARED_SPTR oligomer = prepare_reactant(visited.at(frontier[i]));
+            expanded[i] = run_reaction_pair(rxn, *oligomer, monomer, filter, symmetric);
+        }, options.threads);
+
+        std::vector<std::string> next;
+        for(auto &products: expanded){
+            for(auto &p: products){
+                StageTimer timer(Stage::Dedupe);
+                if(res.insert(p).second){
+                    p.second->setProp("_length", length);
+                    next.push_back(p.first);
+                }
+            }
+        }
+        frontier = std::move(next);
+    }
+    return res;
+}
+
+std::unordered_map<std::string, RXN_SPTR> generate_bridges(const PreparedReactant &mol, BridgeKeyCache *cache, unsigned int threads){
+    std::unordered_map<std::string, RXN_SPTR> uniqueReactions;
+    BridgeKeyCache localCache;
+    if(!cache){
+        cache = &localCache;
+    }
+
+    // Hydrogens are added once, heavy atoms keep their indices and the hydrogens go at the end
+    RDKit::ROMOL_SPTR hmol(RDKit::MolOps::addHs(*mol.reactant));
+    std::vector<int> hBonds = hydrogen_bonds(*hmol, mol.reactant->getNumAtoms());
+
+    RDKit::UINT_VECT hAtoms;
+    for(unsigned int i = 0; i < hBonds.size(); i ++){
+        if(hBonds[i] != -1){
+            hAtoms.push_back(i);
+        }
+    }
+
+    struct Candidate {
+        unsigned int idx1, idx2;
+        BridgeFragment fragment;
+        std::string key;
+        RXN_SPTR rxn;
+    };
+    std::vector<Candidate> candidates;
+
+    // One candidate per orbit of atom pairs: a pair is kept only if no automorphism
+    // maps it onto a smaller one. Asymmetric molecules only have the identity, so
+    // every pair is its own orbit.
+    std::vector<RDKit::UINT_VECT> group = automorphisms(*mol.reactant);
+    for(unsigned int i = 0; i < hAtoms.size(); i ++){
+        for(unsigned int j = i+1; j < hAtoms.size(); j ++){
+            unsigned int a = hAtoms[i], b = hAtoms[j];
+            bool representative = true;
+            for(const auto &perm: group){
+                unsigned int x = std::min(perm[a], perm[b]);
+                unsigned int y = std::max(perm[a], perm[b]);
+                if(x < a || (x == a && y < b)){
+                    representative = false;
+                    break;
+                }
+            }
+            if(representative){
+                candidates.push_back({unsigned(hBonds[a]), unsigned(hBonds[b]), {}, "", nullptr});
+            }
+        }
+    }
+
+    parallel_for(candidates.size(), [&](size_t i){
+        Candidate &c = candidates[i];
+        c.fragment = cut_bridge(*hmol, c.idx1, c.idx2);
+        if(cache->find(c.fragment.key, c.key)){
+            return; // Known bridge, no need to build the reaction and run the probe
+        }
+        c.rxn = fragment_to_reaction(c.fragment, c.idx1, c.idx2);
+        c.key = get_reaction_key(c.rxn);
+        cache->insert(c.fragment.key, c.key);
+    }, threads);
+
+    // The first candidate of every key, in enumeration order, provides its reaction,
+    // so the result does not depend on how the threads were scheduled
+    std::vector<Candidate*> unbuilt;
+    for(auto &c: candidates){
+        if(c.key.empty() || uniqueReactions.contains(c.key)){
+            continue;
+        }
+        uniqueReactions.insert(std::make_pair(c.key, c.rxn));
+        if(!c.rxn){
+            unbuilt.push_back(&c);
+        }
+    }
+    parallel_for(unbuilt.size(), [&](size_t i){
+        unbuilt[i]->rxn = fragment_to_reaction(unbuilt[i]->fragment, unbuilt[i]->idx1, unbuilt[i]->idx2);
+    }, threads);
+    for(auto c: unbuilt){
+        uniqueReactions[c->key] = c->rxn;
+    }
+    return uniqueReactions;
+}
+
+std::unordered_map<std::string, RXN_SPTR> generate_bridges(RDKit::ROMOL_SPTR mol, BridgeKeyCache *cache, unsigned int threads){
+    return generate_bridges(*prepare_reactant(mol), cache, threads);
+}
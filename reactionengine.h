@@ -0,0 +1,135 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <GraphMol/GraphMol.h>
+#include <GraphMol/ChemReactions/Reaction.h>
+
+#define RXN_SPTR boost::shared_ptr<RDKit::ChemicalReaction>
+
+// Widget-free part of the generator. Everything declared here only depends on
+// RDKit, so it is shared by the Qt application and the command line driver.
+
+// A reaction product together with its canonical SMILES, which is computed once
+// and then used as its identity for deduplication, display and export
+struct Product {
+    std::string smiles;
+    RDKit::ROMOL_SPTR mol;
+};
+
+// Everything about a monomer that does not depend on the reaction. It is built
+// once per input molecule and shared, read-only, by every reaction of a run.
+struct PreparedReactant {
+    RDKit::ROMOL_SPTR mol;                  // The molecule as it was given
+    RDKit::ROMOL_SPTR reactant;             // H-stripped copy with every atom protected, see protected_reactant
+    std::string smiles;                     // Canonical SMILES of the reactant, its identity across runs
+    RDKit::UINT_VECT ranks;                 // Canonical ranks of the reactant atoms, ties are not broken
+    std::vector<RDKit::UINT_VECT> classes;  // Atoms of each symmetry class
+    RDKit::UINT_VECT sites;                 // One representative atom per symmetry class
+};
+
+typedef std::shared_ptr<const PreparedReactant> PREPARED_SPTR;
+
+// Limits a raw product has to respect to be kept, 0 disables a limit. The checks
+// run on the raw runReactants output, cheapest first, so a rejected product is
+// never canonicalized, deduplicated or depicted. Products that fail sanitization
+// are always rejected. Rejections are counted on the RunStats of the thread.
+struct ProductFilter {
+    unsigned int maxHeavyAtoms = 0;
+    unsigned int maxRings = 0;
+    double maxMolWt = 0;
+
+    bool empty() const { return !maxHeavyAtoms && !maxRings && maxMolWt <= 0; }
+
+    // Identity of the settings, results of different filters are cached apart
+    std::string key() const;
+};
+
+PREPARED_SPTR prepare_reactant(RDKit::ROMOL_SPTR mol);
+
+// One atom index per symmetry class of the molecule
+RDKit::UINT_VECT unique_atoms(RDKit::ROMOL_SPTR mol);
+
+// H-stripped copy of the molecule with every atom protected from reacting.
+// It is never modified afterwards and can be shared between threads.
+RDKit::ROMOL_SPTR protected_reactant(const RDKit::ROMol &mol);
+
+// Dimerisation products when only atom `site` of a protected reactant may react.
+// Each product records the site in its private "_site" property.
+std::vector<Product> run_reaction_at_site(RXN_SPTR rxn, const RDKit::ROMol &reactant, const unsigned int site, const ProductFilter *filter = nullptr);
+
+// Representative sites at which every reactant template of rxn matches. Matches
+// are computed once, so sites that cannot react are never handed to runReactants.
+RDKit::UINT_VECT reactive_sites(RXN_SPTR rxn, const PreparedReactant &mol);
+
+// Runs the dimerisation once per reactive symmetry unique atom, products are keyed by canonical SMILES.
+// The input molecule is only read, so concurrent calls on the same molecule are safe.
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_reaction_with_symm(RXN_SPTR rxn, const PreparedReactant &mol, const int expected_molecules = 128, const ProductFilter *filter = nullptr);
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_reaction_with_symm(RXN_SPTR rxn, RDKit::ROMOL_SPTR mol, const int expected_molecules = 128);
+
+// Representative sites of mol matched by one reactant template of rxn
+RDKit::UINT_VECT reactive_sites(RXN_SPTR rxn, const PreparedReactant &mol, const unsigned int templateIdx);
+
+// True if exchanging the two reactants of rxn gives the same products, as for a biaryl
+// coupling or a bridge that looks the same from both ends. Undecidable cases are false.
+bool symmetric_reaction(RXN_SPTR rxn);
+
+// Products of a two-reactant reaction between a and b, each opened at one representative
+// site, with a in the first and then in the second template. The second order is skipped
+// when rxn is symmetric, see symmetric_reaction. Products record the site of a.
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_reaction_pair(RXN_SPTR rxn, const PreparedReactant &a, const PreparedReactant &b, const ProductFilter *filter = nullptr, const bool symmetric = false);
+
+// Dimers of a and b, or the symmetry-reduced homodimers when they are the same monomer
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_cross_pair(RXN_SPTR rxn, const PreparedReactant &a, const PreparedReactant &b, const bool symmetric, const ProductFilter *filter = nullptr);
+
+// Chain growth beyond dimers: the new products of every generation react once more with the monomer
+struct OligomerOptions {
+    unsigned int maxLength = 2;  // Monomer units in the largest oligomer, 2 only builds dimers
+    size_t maxFrontier = 0;      // Oligomers expanded per generation at most, 0 for all of them
+    unsigned int threads = 0;    // Threads expanding a generation, 0 for all cores
+
+    // Identity of the settings, results of different lengths are cached apart
+    std::string key() const;
+};
+
+// Dimers, trimers and so on up to options.maxLength, keyed by canonical SMILES. Each
+// generation is expanded in parallel and only with the oligomers no earlier generation
+// produced, so an oligomer is never expanded twice. Products record their number of
+// monomer units in the private "_length" property. When the frontier is cut to
+// maxFrontier, the oligomers with the smallest keys are kept.
+// The generations are not built alike: dimers come from run_reaction_with_symm, which
+// joins two copies of the monomer at the same representative site only, exactly as a
+// maxLength of 2 does. Every later generation goes through run_reaction_pair, which
+// joins an oligomer and the monomer at every pair of representative sites. Trimers can
+// therefore hold links between unlike sites that no dimer of this run has.
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> generate_oligomers(RXN_SPTR rxn, const PreparedReactant &monomer, const OligomerOptions &options, const ProductFilter *filter = nullptr);
+
+// Bridge reaction joining two monomers through what is left of mol once the
+// C-H bonds idx1 and idx2 of its hydrogen-complete form are cut
+RXN_SPTR mol_to_reaction(const RDKit::ROMOL_SPTR mol, const unsigned int idx1, const unsigned int idx2);
+
+// Canonical identity of bridge reactions, keyed on the bridge fragment cut out of
+// the template molecule. An equivalent bridge is then recognized without running
+// the benzene probe again. Safe to share between threads and template molecules.
+class BridgeKeyCache
+{
+public:
+    bool find(const std::string &fragment, std::string &key) const;
+    void insert(const std::string &fragment, const std::string &key);
+    size_t size() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::string> m_keys;
+};
+
+// Bridge reactions derived from a template molecule, keyed by their product on benzene.
+// Every pair of C-H sites is tried once per orbit under the molecule's automorphisms,
+// asymmetric templates included. Candidates are evaluated on threads threads, 0 for
+// all cores; callers already running templates in parallel pass 1.
+std::unordered_map<std::string, RXN_SPTR> generate_bridges(const PreparedReactant &mol, BridgeKeyCache *cache = nullptr, unsigned int threads = 0);
+std::unordered_map<std::string, RXN_SPTR> generate_bridges(RDKit::ROMOL_SPTR mol, BridgeKeyCache *cache = nullptr, unsigned int threads = 0);
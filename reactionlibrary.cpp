@@ -0,0 +1,233 @@
+#include "reactionlibrary.h"
+#include "parallel.h"
+#include "projectfile.h"
+
+#include <GraphMol/ChemReactions/ReactionParser.h>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    // One reaction as read from a file, parsed later on a worker
+    struct RawReaction {
+        std::string file;
+        size_t record;
+        size_t line;
+        std::string text;
+        bool block; // A whole .rxn file rather than a line of SMARTS
+    };
+
+    struct Parsed {
+        LibraryReaction reaction;
+        std::string error;
+    };
+
+    bool has_suffix(const std::string &s, const std::string &suffix){
+        return s.size() >= suffix.size() && std::equal(suffix.rbegin(), suffix.rend(), s.rbegin(),
+                                                       [](char a, char b){ return a == std::tolower((unsigned char)b); });
+    }
+
+    std::string without_gz(const std::string &path){
+        return has_suffix(path, ".gz") ? path.substr(0, path.size() - 3) : path;
+    }
+
+    bool read_file(const std::string &file, std::vector<RawReaction> &records, std::vector<ReadError> &errors){
+        std::ifstream raw(file, std::ios::binary);
+        if(!raw){
+            errors.push_back({file, 0, 0, "cannot open file"});
+            return false;
+        }
+        boost::iostreams::filtering_istream in;
+        if(has_suffix(file, ".gz")){
+            in.push(boost::iostreams::gzip_decompressor());
+        }
+        in.push(raw);
+
+        size_t lineNo = 0, recordNo = 0;
+        try{
+            if(has_suffix(without_gz(file), ".rxn")){
+                std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                records.push_back({file, 1, 1, std::move(text), true});
+                return true;
+            }
+            std::string line;
+            while(std::getline(in, line)){
+                lineNo ++;
+                if(!line.empty() && line.back() == '\r'){
+                    line.pop_back();
+                }
+                size_t start = line.find_first_not_of(" \t");
+                if(start == std::string::npos || line[start] == '#'){
+                    continue;
+                }
+                records.push_back({file, ++recordNo, lineNo, line.substr(start), false});
+            }
+        }
+        catch(const std::exception &e){
+            // Truncated or corrupt gzip stream, what was read so far is kept
+            errors.push_back({file, recordNo + 1, lineNo + 1, e.what()});
+        }
+        return true;
+    }
+
+    Parsed parse(const RawReaction &raw){
+        Parsed res;
+        RXN_SPTR rxn;
+        std::string name;
+        try{
+            if(raw.block){
+                rxn.reset(RDKit::RxnBlockToChemicalReaction(raw.text));
+                if(rxn){
+                    rxn->getPropIfPresent(RDKit::common_properties::_Name, name);
+                }
+                if(name.empty()){
+                    name = std::filesystem::path(without_gz(raw.file)).stem().string();
+                }
+            }
+            else{
+                // Reaction SMARTS cannot hold whitespace, what follows it is the name
+                size_t space = raw.text.find_first_of(" \t");
+                rxn.reset(RDKit::RxnSmartsToChemicalReaction(raw.text.substr(0, space)));
+                if(space != std::string::npos){
+                    size_t first = raw.text.find_first_not_of(" \t", space);
+                    if(first != std::string::npos){
+                        name = raw.text.substr(first);
+                    }
+                }
+            }
+            if(!rxn){
+                res.error = "not a reaction";
+                return res;
+            }
+            unsigned int warnings, errors;
+            if(!rxn->validate(warnings, errors, true)){
+                res.error = "invalid reaction";
+                return res;
+            }
+            rxn->initReactantMatchers();
+            res.reaction.key = RDKit::ChemicalReactionToRxnSmarts(*rxn);
+        }
+        catch(const std::exception &e){
+            res.error = e.what();
+            return res;
+        }
+        res.reaction.name = name.empty() ? res.reaction.key : name;
+        res.reaction.rxn = rxn;
+        return res;
+    }
+}
+
+bool is_reaction_file(const std::string &path){
+    std::string plain = without_gz(path);
+    return has_suffix(plain, ".rxn") || has_suffix(plain, ".smarts") || has_suffix(plain, ".txt");
+}
+
+size_t ReactionLibrary::import(const std::string &path, std::vector<ReadError> &errors, unsigned int threads){
+    std::vector<std::string> files;
+    std::error_code ec;
+    if(std::filesystem::is_directory(path, ec)){
+        for(const auto &entry: std::filesystem::directory_iterator(path, ec)){
+            if(entry.is_regular_file() && is_reaction_file(entry.path().string())){
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    }
+    else{
+        files.push_back(path);
+    }
+
+    // Reading is sequential and cheap, parsing is what runs on all cores
+    std::vector<RawReaction> records;
+    for(const auto &file: files){
+        read_file(file, records, errors);
+    }
+    std::vector<Parsed> parsed(records.size());
+    parallel_for(records.size(), [&](size_t i){
+        parsed[i] = parse(records[i]);
+    }, threads);
+
+    // Added in file order, so the first of several duplicates keeps its name
+    size_t added = 0;
+    for(size_t i = 0; i < parsed.size(); i ++){
+        if(!parsed[i].error.empty()){
+            errors.push_back({records[i].file, records[i].record, records[i].line, parsed[i].error});
+        }
+        else if(add(std::move(parsed[i].reaction))){
+            added ++;
+        }
+    }
+    return added;
+}
+
+bool ReactionLibrary::load(const std::string &path, std::string &error, unsigned int threads){
+    ProjectReader reader;
+    if(!reader.open(path)){
+        error = reader.error();
+        return false;
+    }
+    load(reader, threads);
+    return true;
+}
+
+size_t ReactionLibrary::load(const ProjectReader &reader, unsigned int threads){
+    std::vector<LibraryReaction> loaded(reader.reactions());
+    parallel_for(loaded.size(), [&](size_t i){
+        loaded[i].name = reader.reaction_name(i);
+        loaded[i].rxn = reader.reaction(i);
+        loaded[i].key = RDKit::ChemicalReactionToRxnSmarts(*loaded[i].rxn);
+    }, threads);
+
+    size_t added = 0;
+    for(auto &r: loaded){
+        if(add(std::move(r))){
+            added ++;
+        }
+    }
+    return added;
+}
+
+bool ReactionLibrary::save(const std::string &path, std::string &error) const{
+    ProjectWriter writer;
+    for(const auto &r: m_reactions){
+        writer.add_reaction(r.name, *r.rxn);
+    }
+    if(!writer.write(path)){
+        error = writer.error();
+        return false;
+    }
+    return true;
+}
+
+bool ReactionLibrary::add(const std::string &name, RXN_SPTR rxn){
+    LibraryReaction r;
+    r.key = RDKit::ChemicalReactionToRxnSmarts(*rxn);
+    r.name = name.empty() ? r.key : name;
+    r.rxn = std::move(rxn);
+    return add(std::move(r));
+}
+
+bool ReactionLibrary::add(LibraryReaction reaction){
+    if(!m_keys.insert(reaction.key).second){
+        m_duplicates ++;
+        return false;
+    }
+    m_reactions.push_back(std::move(reaction));
+    return true;
+}
+
+bool ReactionLibrary::contains(const std::string &key) const{
+    return m_keys.count(key);
+}
+
+void ReactionLibrary::clear(){
+    m_reactions.clear();
+    m_keys.clear();
+    m_duplicates = 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "moleculereader.h"
+#include "reactionengine.h"
+
+class ProjectReader;
+
+// A compiled reaction under the name it is listed with. The name is what runs
+// report the reaction as, in the GUI and the CLI alike. The key is its reaction
+// SMARTS as RDKit writes it, which tells duplicates apart.
+struct LibraryReaction {
+    std::string name;
+    std::string key;
+    RXN_SPTR rxn;
+};
+
+// True for the files import() reads from a directory: .rxn files and
+// .smarts/.txt lists, gzipped or not
+bool is_reaction_file(const std::string &path);
+
+// Ordered set of compiled reactions with matchers initialized, ready to run.
+// Text lists of reaction SMARTS and .rxn files are parsed on all cores. A
+// library is saved in the layout of a project file holding only reactions, as
+// ReactionPickler pickles, so loading it only unpickles; the reactions of any
+// project can be loaded the same way.
+class ReactionLibrary
+{
+public:
+    ReactionLibrary() = default;
+
+    // Reads path, an .rxn file, a list with one "SMARTS [name]" per line where
+    // blank lines and lines starting with # are skipped, or a directory of such
+    // files. Bad records go to errors and are skipped. Returns the number of
+    // reactions added, those already in the library are counted as duplicates.
+    size_t import(const std::string &path, std::vector<ReadError> &errors, unsigned int threads = 0);
+
+    // Appends the reactions of a library or project file
+    bool load(const std::string &path, std::string &error, unsigned int threads = 0);
+    size_t load(const ProjectReader &reader, unsigned int threads = 0);
+
+    // Written aside and renamed like a project
+    bool save(const std::string &path, std::string &error) const;
+
+    // An empty name lists the reaction under its key. False for a duplicate.
+    bool add(const std::string &name, RXN_SPTR rxn);
+    bool add(LibraryReaction reaction);
+    bool contains(const std::string &key) const;
+    void clear();
+
+    size_t size() const { return m_reactions.size(); }
+    bool empty() const { return m_reactions.empty(); }
+    const LibraryReaction &operator[](size_t i) const { return m_reactions[i]; }
+    const std::vector<LibraryReaction> &reactions() const { return m_reactions; }
+    size_t duplicates() const { return m_duplicates; }
+
+private:
+    std::vector<LibraryReaction> m_reactions;
+    std::unordered_set<std::string> m_keys;
+    size_t m_duplicates = 0;
+};
@@ -0,0 +1,100 @@
+#include "reactionloader.h"
+#include "parallel.h"
+
+#include <QRunnable>
+
+ReactionLoader::ReactionLoader(QObject *parent)
+    : QObject{parent},
+      m_pending(0)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+ReactionLoader::~ReactionLoader(){
+    blockSignals(true);
+    m_pool.waitForDone();
+}
+
+void ReactionLoader::start(LOAD_FN load){
+    m_pending ++;
+    m_pool.start(QRunnable::create([this, load](){
+        auto library = std::make_shared<ReactionLibrary>();
+        std::vector<ReadError> errors;
+        std::string error;
+        try{
+            load(*library, errors, error);
+        }
+        catch(const std::exception &e){
+            error = e.what();
+        }
+        QMetaObject::invokeMethod(this, [this, library, errors, error](){
+            load_done(library, errors, error);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void ReactionLoader::start_bridges(const QStringList &paths){
+    std::vector<std::string> files;
+    for(const auto &p: paths){
+        files.push_back(p.toStdString());
+    }
+    start([files](ReactionLibrary &library, std::vector<ReadError> &errors, std::string &){
+        std::vector<RDKit::ROMOL_SPTR> mols;
+        for(const auto &file: files){
+            read_molecules(file, [&mols, &errors](ReadBatch &batch){
+                for(auto &m: batch.molecules){
+                    mols.push_back(m.mol);
+                }
+                errors.insert(errors.end(), batch.errors.begin(), batch.errors.end());
+                return true;
+            });
+        }
+
+        // Templates on all cores, each on one thread so the pools do not nest
+        BridgeKeyCache keys;
+        std::vector<std::unordered_map<std::string, RXN_SPTR>> bridges(mols.size());
+        parallel_for(mols.size(), [&](size_t i){
+            bridges[i] = generate_bridges(mols[i], &keys, 1);
+        });
+
+        // Merged on the bridge key like the CLI does, the first template of a key
+        // provides its reaction and the listing keeps template order
+        std::unordered_map<std::string, RXN_SPTR> bridgeReactions;
+        for(const auto &found: bridges){
+            for(const auto &p: found){
+                if(bridgeReactions.insert(p).second){
+                    library.add("", p.second);
+                }
+            }
+        }
+    });
+}
+
+void ReactionLoader::start_import(const QStringList &paths){
+    std::vector<std::string> files;
+    for(const auto &p: paths){
+        files.push_back(p.toStdString());
+    }
+    start([files](ReactionLibrary &library, std::vector<ReadError> &errors, std::string &){
+        for(const auto &file: files){
+            library.import(file, errors);
+        }
+    });
+}
+
+void ReactionLoader::start_library(const QString &path){
+    std::string file = path.toStdString();
+    start([file](ReactionLibrary &library, std::vector<ReadError> &, std::string &error){
+        library.load(file, error);
+    });
+}
+
+void ReactionLoader::load_done(std::shared_ptr<const ReactionLibrary> library, const std::vector<ReadError> &errors,
+                               const std::string &error){
+    m_pending --;
+    emit finished(library, errors, QString::fromStdString(error));
+}
+
+bool ReactionLoader::is_running() const{
+    return m_pending > 0;
+}
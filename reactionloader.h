@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "moleculereader.h"
+#include "reactionlibrary.h"
+
+// Builds a ReactionLibrary on a background thread, from bridge templates,
+// reaction files or a saved library, and delivers it on the thread that owns
+// the loader. The parsing itself runs on all cores.
+class ReactionLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReactionLoader(QObject *parent = nullptr);
+    ~ReactionLoader();
+
+    // Bridge reactions of every template molecule in paths
+    void start_bridges(const QStringList &paths);
+    // Reactions of SMARTS lists, .rxn files or directories of them
+    void start_import(const QStringList &paths);
+    // Reactions of a reaction library or project
+    void start_library(const QString &path);
+
+    bool is_running() const;
+
+signals:
+    // error is set when the whole load failed
+    void finished(std::shared_ptr<const ReactionLibrary> library, const std::vector<ReadError> &errors, const QString &error);
+
+private:
+    typedef std::function<void(ReactionLibrary &library, std::vector<ReadError> &errors, std::string &error)> LOAD_FN;
+
+    void start(LOAD_FN load);
+    void load_done(std::shared_ptr<const ReactionLibrary> library, const std::vector<ReadError> &errors,
+                   const std::string &error);
+
+    QThreadPool m_pool;
+    int m_pending; // Loads run one after the other, each one delivers its own library
+};
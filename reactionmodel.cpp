@@ -0,0 +1,61 @@
+#include "reactionmodel.h"
+
+ReactionModel::ReactionModel(QObject *parent)
+    : QAbstractTableModel{parent}
+{
+}
+
+int ReactionModel::rowCount(const QModelIndex &parent) const{
+    return parent.isValid() ? 0 : int(m_library.size());
+}
+
+int ReactionModel::columnCount(const QModelIndex &parent) const{
+    return parent.isValid() ? 0 : 1;
+}
+
+QVariant ReactionModel::data(const QModelIndex &index, int role) const{
+    if(!index.isValid() || index.row() >= rowCount()){
+        return QVariant();
+    }
+    const LibraryReaction &r = m_library[index.row()];
+    if(role == Qt::DisplayRole){
+        return QString::fromStdString(r.name);
+    }
+    if(role == Qt::ToolTipRole){
+        return QString::fromStdString(r.name == r.key ? r.key : r.name + "\n" + r.key);
+    }
+    return QVariant();
+}
+
+size_t ReactionModel::append(const ReactionLibrary &library){
+    std::vector<const LibraryReaction*> fresh;
+    for(const auto &r: library.reactions()){
+        if(!m_library.contains(r.key)){
+            fresh.push_back(&r);
+        }
+    }
+    if(fresh.empty()){
+        return 0;
+    }
+    int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + int(fresh.size()) - 1);
+    for(const auto *r: fresh){
+        m_library.add(*r);
+    }
+    endInsertRows();
+    return fresh.size();
+}
+
+void ReactionModel::clear(){
+    beginResetModel();
+    m_library.clear();
+    endResetModel();
+}
+
+const LibraryReaction &ReactionModel::reaction(int row) const{
+    return m_library[row];
+}
+
+const ReactionLibrary &ReactionModel::library() const{
+    return m_library;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QAbstractTableModel>
+
+#include "reactionlibrary.h"
+
+// Table of the reactions of a session, one row per reaction of its library.
+// Rows are drawn by a ReactionDelegate, so thousands of reactions cost no widgets.
+class ReactionModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ReactionModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Appends the reactions not listed yet, returns how many there were
+    size_t append(const ReactionLibrary &library);
+    void clear();
+
+    const LibraryReaction &reaction(int row) const;
+    const ReactionLibrary &library() const;
+
+private:
+    ReactionLibrary m_library;
+};
@@ -0,0 +1,81 @@
+#include "rendercache.h"
+
+#include <QPainter>
+#include <QRunnable>
+#include <QThread>
+
+#include <algorithm>
+
+RenderCache::RenderCache(QObject *parent, int maxBytes)
+    : QObject{parent},
+      m_cache(maxBytes),
+      m_generation(0)
+{
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+RenderCache::~RenderCache(){
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QString RenderCache::key(const void *identity, const QString &name, const QSize &size, qreal dpr, const QString &variant){
+    return QString("%1|%2|%3x%4@%5|%6")
+        .arg(quintptr(identity), 0, 16)
+        .arg(name)
+        .arg(size.width()).arg(size.height())
+        .arg(dpr)
+        .arg(variant);
+}
+
+QPixmap RenderCache::find(const QString &key) const{
+    QPixmap *pixmap = m_cache.object(key);
+    return pixmap ? *pixmap : QPixmap();
+}
+
+void RenderCache::request(const QString &key, const QSize &size, qreal dpr, DRAW_FN draw){
+    if(size.isEmpty() || m_pending.contains(key) || m_cache.contains(key)){
+        return;
+    }
+    m_pending.insert(key);
+
+    unsigned int generation = m_generation;
+    m_pool.start(QRunnable::create([this, generation, key, size, dpr, draw = std::move(draw)](){
+        // QPixmap only lives on the GUI thread, workers draw into a QImage
+        QImage image(size * dpr, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(dpr);
+        image.fill(Qt::transparent);
+        try{
+            QPainter painter(&image);
+            painter.setRenderHint(QPainter::Antialiasing, true);
+            painter.setRenderHint(QPainter::TextAntialiasing, true);
+            draw(painter, size);
+        }
+        catch(const std::exception &){
+            image = QImage();
+        }
+        QMetaObject::invokeMethod(this, [this, generation, key, image](){
+            rendered(generation, key, image);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void RenderCache::rendered(unsigned int generation, const QString &key, const QImage &image){
+    if(generation != m_generation){
+        return;
+    }
+    m_pending.remove(key);
+    if(image.isNull()){
+        return;
+    }
+    QPixmap *pixmap = new QPixmap(QPixmap::fromImage(image));
+    m_cache.insert(key, pixmap, int(std::min<qint64>(qint64(image.sizeInBytes()), m_cache.maxCost())));
+    emit ready(key);
+}
+
+void RenderCache::clear(){
+    m_pool.clear();
+    m_generation ++;
+    m_pending.clear();
+    m_cache.clear();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QThreadPool>
+
+#include <functional>
+
+class QPainter;
+
+// Rendered structures kept as pixmaps, keyed by what was drawn, its size and the
+// device pixel ratio. Misses are drawn into an image on worker threads and turned
+// into a pixmap on the thread that owns the cache, so scrolling never waits for
+// MolDraw2D.
+class RenderCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Draws into a painter whose logical size is size
+    typedef std::function<void(QPainter &painter, const QSize &size)> DRAW_FN;
+
+    explicit RenderCache(QObject *parent = nullptr, int maxBytes = 128 * 1024 * 1024);
+    ~RenderCache();
+
+    // identity names what is drawn, variant anything else the picture depends on, e.g. its colours
+    static QString key(const void *identity, const QString &name, const QSize &size, qreal dpr, const QString &variant = QString());
+
+    // Cached pixmap or a null one. On a miss call request().
+    QPixmap find(const QString &key) const;
+
+    // Renders in the background unless the key is cached or already on its way,
+    // ready(key) is emitted once find(key) has it
+    void request(const QString &key, const QSize &size, qreal dpr, DRAW_FN draw);
+
+    void clear();
+
+signals:
+    void ready(const QString &key);
+
+private:
+    void rendered(unsigned int generation, const QString &key, const QImage &image);
+
+    QCache<QString, QPixmap> m_cache; // Cost is in bytes
+    QSet<QString> m_pending;
+    QThreadPool m_pool;
+    unsigned int m_generation; // Bumped by clear() so renders already running are dropped
+};
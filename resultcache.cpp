@@ -0,0 +1,264 @@
+#include "resultcache.h"
+
+#include <GraphMol/MolPickler.h>
+#include <GraphMol/ChemReactions/ReactionParser.h>
+#include <RDGeneral/versions.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Bump whenever the products of a given reaction and monomer change, old cells are then ignored
+    const char *engine_version = "2";
+
+    const char magic[4] = {'D', 'G', 'R', 'C'};
+    const uint32_t format_version = 1;
+
+    uint64_t fnv1a(const std::string &s){
+        uint64_t h = 14695981039346656037ull;
+        for(unsigned char c: s){
+            h = (h ^ c) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    void write_string(std::ostream &out, const std::string &s){
+        uint32_t size = s.size();
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(s.data(), size);
+    }
+
+    bool read_string(std::istream &in, std::string &s){
+        uint32_t size;
+        if(!in.read(reinterpret_cast<char*>(&size), sizeof(size))){
+            return false;
+        }
+        s.resize(size);
+        return bool(in.read(s.data(), size));
+    }
+
+    // A cell serves every atom order of its monomer, so the _site of a dimer is
+    // stored as the canonical rank of the site. Longer oligomers record a site of
+    // the oligomer they grew from, which no rank of the monomer names, so it is dropped.
+    void sites_to_ranks(const std::unordered_map<std::string, RDKit::ROMOL_SPTR> &products, const PreparedReactant &mol){
+        for(const auto &p: products){
+            unsigned int site, length = 2;
+            p.second->getPropIfPresent("_length", length);
+            if(!p.second->getPropIfPresent("_site", site)){
+                continue;
+            }
+            if(length > 2 || site >= mol.ranks.size()){
+                p.second->clearProp("_site");
+            }
+            else{
+                p.second->setProp("_site", unsigned(mol.ranks[site]));
+            }
+        }
+    }
+
+    // Back to atoms of mol, the representative of each symmetry class as a fresh run would pick
+    void ranks_to_sites(const std::unordered_map<std::string, RDKit::ROMOL_SPTR> &products, const PreparedReactant &mol){
+        std::unordered_map<unsigned int, unsigned int> atoms;
+        for(auto site: mol.sites){
+            atoms[mol.ranks[site]] = site;
+        }
+        for(const auto &p: products){
+            unsigned int rank;
+            if(!p.second->getPropIfPresent("_site", rank)){
+                continue;
+            }
+            auto it = atoms.find(rank);
+            if(it != atoms.end()){
+                p.second->setProp("_site", it->second);
+            }
+            else{
+                p.second->clearProp("_site");
+            }
+        }
+    }
+}
+
+ResultCache::ResultCache(const std::string &directory)
+    : m_directory(directory)
+{
+}
+
+std::string ResultCache::reaction_key(const RDKit::ChemicalReaction &rxn){
+    return RDKit::ChemicalReactionToRxnSmarts(rxn);
+}
+
+std::string ResultCache::cell_key(const std::string &reaction, const std::string &monomer) const{
+    return std::string(engine_version) + "\n" + RDKit::rdkitVersion + "\n" + reaction + "\n" + monomer;
+}
+
+std::string ResultCache::cell_path(const std::string &key) const{
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)fnv1a(key));
+    // Cells are spread over 256 directories so none of them grows too large
+    return (std::filesystem::path(m_directory) / std::string(name, 2) / (std::string(name + 2) + ".dgrc")).string();
+}
+
+bool ResultCache::load(const std::string &reaction, const std::string &monomer, std::unordered_map<std::string, RDKit::ROMOL_SPTR> &products) const{
+    std::string key = cell_key(reaction, monomer);
+    std::ifstream in(cell_path(key), std::ios::binary);
+
+    char fileMagic[4];
+    uint32_t version = 0, count = 0;
+    std::string fileKey;
+    bool valid = in
+        && in.read(fileMagic, sizeof(fileMagic)) && std::equal(fileMagic, fileMagic + 4, magic)
+        && in.read(reinterpret_cast<char*>(&version), sizeof(version)) && version == format_version
+        && read_string(in, fileKey) && fileKey == key // Rules out hash collisions
+        && in.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    std::unordered_map<std::string, RDKit::ROMOL_SPTR> res;
+    res.reserve(count);
+    for(uint32_t i = 0; valid && i < count; i ++){
+        std::string smiles, pickle;
+        valid = read_string(in, smiles) && read_string(in, pickle);
+        if(!valid){
+            break;
+        }
+        try{
+            res.insert(std::make_pair(std::move(smiles), RDKit::ROMOL_SPTR(new RDKit::ROMol(pickle))));
+        }
+        catch(const std::exception &){
+            valid = false;
+        }
+    }
+
+    if(!valid){
+        m_misses ++;
+        return false;
+    }
+    m_hits ++;
+    // The modification time doubles as the last use, trim() evicts the oldest
+    std::error_code ec;
+    std::filesystem::last_write_time(cell_path(key), std::filesystem::file_time_type::clock::now(), ec);
+    products = std::move(res);
+    return true;
+}
+
+bool ResultCache::store(const std::string &reaction, const std::string &monomer, const std::unordered_map<std::string, RDKit::ROMOL_SPTR> &products) const{
+    std::string key = cell_key(reaction, monomer);
+    std::filesystem::path path = cell_path(key);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // Written aside and renamed, so readers and concurrent writers never see half a cell.
+    // Shard processes, possibly on other hosts, share the directory, so the name
+    // holds the process, the thread, a per-process random tag and a counter.
+    static const uint64_t tag = std::random_device()() ^ (uint64_t(std::random_device()()) << 32);
+    static std::atomic<uint64_t> counter{0};
+    std::ostringstream suffix;
+    suffix << ".tmp" << getpid() << "-" << std::hex << tag << "-" << std::hash<std::thread::id>()(std::this_thread::get_id())
+           << "-" << counter++;
+    std::filesystem::path tmp = path;
+    tmp += suffix.str();
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        uint32_t count = products.size();
+        out.write(magic, sizeof(magic));
+        out.write(reinterpret_cast<const char*>(&format_version), sizeof(format_version));
+        write_string(out, key);
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+        std::string pickle;
+        for(const auto &p: products){
+            RDKit::MolPickler::pickleMol(*p.second, pickle, RDKit::PicklerOps::MolProps | RDKit::PicklerOps::PrivateProps);
+            write_string(out, p.first);
+            write_string(out, pickle);
+        }
+        if(!out.flush()){
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if(ec){
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_reaction_cached(RXN_SPTR rxn, const std::string &reactionKey, const PreparedReactant &mol, const ResultCache *cache,
+                                                                       const ProductFilter *filter, const OligomerOptions *oligomers){
+    bool grow = oligomers && oligomers->maxLength > 2;
+    std::string key = reactionKey;
+    if(filter && !filter->empty()){
+        key += "\n" + filter->key();
+    }
+    if(grow){
+        key += "\n" + oligomers->key();
+    }
+
+    std::unordered_map<std::string, RDKit::ROMOL_SPTR> products;
+    if(cache && cache->load(key, mol.smiles, products)){
+        ranks_to_sites(products, mol);
+        return products;
+    }
+    products = grow ? generate_oligomers(rxn, mol, *oligomers, filter) : run_reaction_with_symm(rxn, mol, 128, filter);
+    if(cache){
+        // The products are still private to this call, so their sites are translated in place and back
+        sites_to_ranks(products, mol);
+        cache->store(key, mol.smiles, products);
+        ranks_to_sites(products, mol);
+    }
+    return products;
+}
+
+size_t ResultCache::trim(uint64_t maxBytes) const{
+    struct Cell {
+        std::filesystem::file_time_type used;
+        uint64_t size;
+        std::filesystem::path path;
+    };
+    std::vector<Cell> cells;
+    uint64_t total = 0;
+    std::error_code ec;
+    for(auto it = std::filesystem::recursive_directory_iterator(m_directory, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)){
+        if(!it->is_regular_file(ec) || it->path().extension() != ".dgrc"){
+            continue;
+        }
+        Cell c{it->last_write_time(ec), it->file_size(ec), it->path()};
+        if(!ec){
+            total += c.size;
+            cells.push_back(std::move(c));
+        }
+        ec.clear();
+    }
+    if(total <= maxBytes){
+        return 0;
+    }
+
+    std::sort(cells.begin(), cells.end(), [](const Cell &a, const Cell &b){
+        return a.used < b.used;
+    });
+    size_t removed = 0;
+    for(const auto &c: cells){
+        if(total <= maxBytes){
+            break;
+        }
+        if(std::filesystem::remove(c.path, ec)){
+            total -= c.size;
+            removed ++;
+        }
+    }
+    return removed;
+}
+
+void ResultCache::clear() const{
+    trim(0);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+
+#include "reactionengine.h"
+
+// Products of (reaction, monomer) cells kept on disk between runs. A cell is
+// identified by the canonical reaction SMARTS, the canonical SMILES of the
+// monomer and the engine version, so a result is only reused when the same
+// code would compute it again. Each cell is one small binary file holding the
+// deduplicated products as canonical SMILES plus an RDKit pickle.
+// Safe to share between threads.
+class ResultCache
+{
+public:
+    explicit ResultCache(const std::string &directory);
+
+    // Canonical identity of a reaction in the cache
+    static std::string reaction_key(const RDKit::ChemicalReaction &rxn);
+
+    bool load(const std::string &reaction, const std::string &monomer, std::unordered_map<std::string, RDKit::ROMOL_SPTR> &products) const;
+    bool store(const std::string &reaction, const std::string &monomer, const std::unordered_map<std::string, RDKit::ROMOL_SPTR> &products) const;
+
+    // Removes the least recently used cells until the cache holds at most maxBytes,
+    // returns how many were removed. Hits count as uses.
+    size_t trim(uint64_t maxBytes) const;
+    // Removes every cell
+    void clear() const;
+
+    const std::string &directory() const { return m_directory; }
+    size_t hits() const { return m_hits; }
+    size_t misses() const { return m_misses; }
+
+private:
+    std::string cell_key(const std::string &reaction, const std::string &monomer) const;
+    std::string cell_path(const std::string &key) const;
+
+    std::string m_directory;
+    mutable std::atomic<size_t> m_hits{0}, m_misses{0};
+};
+
+// run_reaction_with_symm, or generate_oligomers when oligomers asks for more than
+// dimers, through the cache: a hit is read back, a miss is computed and stored.
+// Without a cache it simply runs the reaction. Results of different filters and
+// oligomer settings are kept apart.
+std::unordered_map<std::string, RDKit::ROMOL_SPTR> run_reaction_cached(RXN_SPTR rxn, const std::string &reactionKey, const PreparedReactant &mol, const ResultCache *cache,
+                                                                       const ProductFilter *filter = nullptr, const OligomerOptions *oligomers = nullptr);
@@ -0,0 +1,263 @@
+#include "shardmanifest.h"
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+namespace {
+    const char *manifest_header = "dimer-generator-manifest 1";
+
+    bool has_suffix(const std::string &s, const std::string &suffix){
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // "products.sdf.gz" is split into "products" and ".sdf.gz"
+    void split_extension(const std::string &path, std::string &stem, std::string &extension){
+        std::string plain = has_suffix(path, ".gz") ? path.substr(0, path.size() - 3) : path;
+        size_t dot = plain.find_last_of('.');
+        size_t slash = plain.find_last_of('/');
+        if(dot == std::string::npos || (slash != std::string::npos && dot < slash)){
+            dot = plain.size();
+        }
+        stem = path.substr(0, dot);
+        extension = path.substr(dot);
+    }
+
+    bool is_sdf(const std::string &path){
+        std::string plain = has_suffix(path, ".gz") ? path.substr(0, path.size() - 3) : path;
+        return has_suffix(plain, ".sdf") || has_suffix(plain, ".sd");
+    }
+
+    bool next_line(std::istream &in, std::string &line){
+        if(!std::getline(in, line)){
+            return false;
+        }
+        if(!line.empty() && line.back() == '\r'){
+            line.pop_back();
+        }
+        return true;
+    }
+
+    // One product record and its canonical SMILES, the first column of a SMILES
+    // line or the smiles tag of an SD record
+    bool next_record(std::istream &in, bool sdf, std::string &record, std::string &key){
+        std::string line;
+        record.clear();
+        key.clear();
+        if(!sdf){
+            while(next_line(in, line)){
+                if(line.empty()){
+                    continue;
+                }
+                key = line.substr(0, line.find('\t'));
+                record = line + "\n";
+                return true;
+            }
+            return false;
+        }
+
+        bool smilesTag = false;
+        while(next_line(in, line)){
+            record += line + "\n";
+            if(smilesTag){
+                key = line;
+                smilesTag = false;
+            }
+            else if(line.compare(0, 4, "$$$$") == 0){
+                return true;
+            }
+            else if(line.find("<smiles>") != std::string::npos && line[0] == '>'){
+                smilesTag = true;
+            }
+        }
+        return !record.empty();
+    }
+}
+
+std::string ShardManifest::shard_path(size_t shard) const{
+    std::string stem, extension;
+    split_extension(output, stem, extension);
+    return stem + ".shard-" + std::to_string(shard) + extension;
+}
+
+std::string ShardManifest::partial_path(size_t shard) const{
+    std::string stem, extension;
+    split_extension(output, stem, extension);
+    return stem + ".shard-" + std::to_string(shard) + ".part" + extension;
+}
+
+bool ShardManifest::shard_done(size_t shard) const{
+    std::error_code ec;
+    return std::filesystem::is_regular_file(shard_path(shard), ec);
+}
+
+bool ShardManifest::write(const std::string &path, std::string &error) const{
+    std::ofstream out(path);
+    if(!out){
+        error = "Cannot open " + path + " for writing";
+        return false;
+    }
+    out << manifest_header << "\n"
+        << "output " << output << "\n"
+        << "reactions " << reactions << "\n"
+        << "molecules " << molecules << "\n"
+        << "cells " << cells << "\n";
+    for(const auto &a: args){
+        out << "arg " << a << "\n";
+    }
+    for(size_t k = 0; k < shards.size(); k ++){
+        out << "shard " << k << " " << shards[k].begin << " " << shards[k].end << "\n";
+    }
+    if(!out.flush()){
+        error = "Cannot write to " + path;
+        return false;
+    }
+    return true;
+}
+
+bool ShardManifest::read(const std::string &path, std::string &error){
+    *this = ShardManifest();
+    std::ifstream in(path);
+    std::string line;
+    if(!in || !next_line(in, line) || line != manifest_header){
+        error = path + " is not a shard manifest";
+        return false;
+    }
+
+    size_t lineNo = 1;
+    while(next_line(in, line)){
+        lineNo ++;
+        if(line.empty()){
+            continue;
+        }
+        size_t space = line.find(' ');
+        std::string field = line.substr(0, space);
+        std::string value = space == std::string::npos ? "" : line.substr(space + 1);
+        try{
+            if(field == "output"){
+                output = value;
+            }
+            else if(field == "arg"){
+                args.push_back(value);
+            }
+            else if(field == "reactions"){
+                reactions = std::stoull(value);
+            }
+            else if(field == "molecules"){
+                molecules = std::stoull(value);
+            }
+            else if(field == "cells"){
+                cells = std::stoull(value);
+            }
+            else if(field == "shard"){
+                size_t index, begin, end;
+                if(sscanf(value.c_str(), "%zu %zu %zu", &index, &begin, &end) != 3 || index != shards.size() || begin > end || end > cells){
+                    throw std::invalid_argument("bad shard");
+                }
+                shards.push_back({begin, end});
+            }
+            else{
+                throw std::invalid_argument("unknown field");
+            }
+        }
+        catch(const std::exception &){
+            error = path + ", line " + std::to_string(lineNo) + ": cannot read \"" + line + "\"";
+            return false;
+        }
+    }
+    if(output.empty() || shards.empty()){
+        error = path + " has no output or no shards";
+        return false;
+    }
+    return true;
+}
+
+std::vector<ShardRange> split_cells(size_t cells, size_t count){
+    count = std::max<size_t>(1, std::min(count, std::max<size_t>(cells, 1)));
+    std::vector<ShardRange> res;
+    for(size_t k = 0; k < count; k ++){
+        res.push_back({cells * k / count, cells * (k + 1) / count});
+    }
+    return res;
+}
+
+bool merge_shards(const ShardManifest &manifest, const std::string &output, MergeResult &result, std::string &error){
+    result = MergeResult();
+    for(size_t k = 0; k < manifest.shards.size(); k ++){
+        if(!manifest.shard_done(k)){
+            result.missing.push_back(k);
+        }
+    }
+    if(!result.missing.empty()){
+        error = std::to_string(result.missing.size()) + " of " + std::to_string(manifest.shards.size()) + " shards are not complete";
+        return false;
+    }
+    bool sdf = is_sdf(manifest.output);
+    if(is_sdf(output) != sdf){
+        error = "The merged file must have the format of the shard files, " + manifest.output;
+        return false;
+    }
+
+    // Written aside and renamed, so a failed merge never leaves half a product file behind
+    std::string tmp = output + ".tmp";
+    std::unordered_set<std::string> seen;
+    {
+        std::ofstream file(tmp, std::ios::binary);
+        if(!file){
+            error = "Cannot open " + tmp + " for writing";
+            return false;
+        }
+        boost::iostreams::filtering_ostream out;
+        if(has_suffix(output, ".gz")){
+            out.push(boost::iostreams::gzip_compressor());
+        }
+        out.push(file);
+
+        std::string record, key;
+        for(size_t k = 0; k < manifest.shards.size(); k ++){
+            std::string path = manifest.shard_path(k);
+            std::ifstream raw(path, std::ios::binary);
+            boost::iostreams::filtering_istream in;
+            if(has_suffix(path, ".gz")){
+                in.push(boost::iostreams::gzip_decompressor());
+            }
+            in.push(raw);
+            try{
+                while(next_record(in, sdf, record, key)){
+                    if(seen.insert(key).second){
+                        out << record;
+                        result.written ++;
+                    }
+                    else{
+                        result.duplicates ++;
+                    }
+                }
+            }
+            catch(const std::exception &e){
+                error = "Cannot read " + path + ": " + e.what() + ", run shard " + std::to_string(k) + " again";
+                out.reset();
+                file.close();
+                std::error_code ec;
+                std::filesystem::remove(tmp, ec);
+                return false;
+            }
+        }
+        out.reset(); // Flushes the gzip trailer
+        if(!file.flush()){
+            error = "Cannot write to " + tmp;
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, output, ec);
+    if(ec){
+        error = "Cannot replace " + output + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
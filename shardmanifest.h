@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Plan of a run split into shards that run as independent processes, on one
+// machine or on the nodes of a batch scheduler. The manifest holds the options
+// and inputs of the run, with bridge reactions already expanded, so every shard
+// sees the same reactions and monomers in the same order. The grid of cells,
+// reaction-major, is cut into contiguous ranges. Shard k writes its products to
+// shard_path(k), and only renames the file into place once it is complete, so
+// a shard whose file exists is done and any other shard can simply be run again.
+
+struct ShardRange {
+    size_t begin;
+    size_t end;
+};
+
+struct ShardManifest {
+    std::string output;             // Final merged product file, shard files are named after it
+    std::vector<std::string> args;  // Command line of the run, without output and shard options
+    size_t reactions = 0;
+    size_t molecules = 0;
+    size_t cells = 0;
+    std::vector<ShardRange> shards;
+
+    std::string shard_path(size_t shard) const;
+    // Where a shard writes before it is complete
+    std::string partial_path(size_t shard) const;
+    bool shard_done(size_t shard) const;
+
+    bool write(const std::string &path, std::string &error) const;
+    bool read(const std::string &path, std::string &error);
+};
+
+// count ranges of about the same size covering [0, cells)
+std::vector<ShardRange> split_cells(size_t cells, size_t count);
+
+struct MergeResult {
+    size_t written = 0;
+    size_t duplicates = 0;
+    std::vector<size_t> missing; // Shards without a complete product file
+};
+
+// Concatenates the shard product files into output, keeping only the first
+// record of every canonical SMILES across all shards. Nothing is written while
+// a shard is missing. Compression of output follows its extension.
+bool merge_shards(const ShardManifest &manifest, const std::string &output, MergeResult &result, std::string &error);
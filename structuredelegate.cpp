@@ -0,0 +1,75 @@
+#include "structuredelegate.h"
+#include "rendercache.h"
+
+#include <QAbstractScrollArea>
+#include <QPainter>
+
+#include <GraphMol/MolDraw2D/Qt/MolDraw2DQt.h>
+
+namespace {
+    const int title_height = 20;
+}
+
+StructureDelegate::StructureDelegate(QObject *parent)
+    : QStyledItemDelegate{parent},
+      m_cache(new RenderCache(this))
+{
+    connect(m_cache, &RenderCache::ready, this, &StructureDelegate::rendered);
+}
+
+void StructureDelegate::rendered(){
+    // Several renders usually land together, update() coalesces the repaints
+    auto *view = qobject_cast<QAbstractScrollArea*>(m_view.data());
+    if(view){
+        view->viewport()->update();
+    }
+    else if(m_view){
+        m_view->update();
+    }
+}
+
+void StructureDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const{
+    Structure s;
+    if(!structure(index, s)){
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setRenderHint(QPainter::TextAntialiasing, true);
+    // Selected rows get their own picture on the highlight colour, so a selection change is a cache miss
+    bool selected = option.state & QStyle::State_Selected;
+    QColor background = option.palette.color(selected ? QPalette::Highlight : QPalette::Base);
+    painter->fillRect(option.rect, background);
+
+    QRect structRect = option.rect.adjusted(0, 0, 0, -title_height);
+    if(s.identity && !structRect.isEmpty()){
+        m_view = const_cast<QWidget*>(option.widget);
+        qreal dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+        QString key = RenderCache::key(s.identity, s.name, structRect.size(), dpr, background.name(QColor::HexArgb));
+        QPixmap pixmap = m_cache->find(key);
+        if(!pixmap.isNull()){
+            painter->drawPixmap(structRect.topLeft(), pixmap);
+        }
+        else{
+            auto draw = s.draw;
+            m_cache->request(key, structRect.size(), dpr, [draw, background](QPainter &qp, const QSize &size){
+                RDKit::MolDraw2DQt drawer(size.width(), size.height(), &qp);
+                drawer.drawOptions().backgroundColour = RDKit::DrawColour(background.redF(), background.greenF(),
+                                                                          background.blueF(), background.alphaF());
+                draw(drawer);
+            });
+        }
+    }
+
+    QRect titleRect(option.rect.left(), structRect.bottom(), option.rect.width(), title_height);
+    painter->setPen(option.palette.color(selected ? QPalette::HighlightedText : QPalette::Text));
+    painter->drawText(titleRect, Qt::AlignCenter,
+                      option.fontMetrics.elidedText(index.data().toString(), Qt::ElideMiddle, titleRect.width()));
+    painter->restore();
+}
+
+QSize StructureDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const{
+    return QSize(400, 200);
+}
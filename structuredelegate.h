@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QPointer>
+#include <QStyledItemDelegate>
+
+#include <functional>
+
+class RenderCache;
+
+namespace RDKit {
+    class MolDraw2DQt;
+}
+
+// Draws the structure of a row with its title underneath. Only rows that are
+// actually on screen are ever painted, structures are rendered once per size
+// into a RenderCache and then blitted. Subclasses only say what a row shows.
+class StructureDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit StructureDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+protected:
+    // What a row shows. identity names it in the cache, a null identity draws nothing
+    // above the title. draw runs on a render thread, so it holds its own references.
+    struct Structure {
+        const void *identity = nullptr;
+        QString name;
+        std::function<void(RDKit::MolDraw2DQt &drawer)> draw;
+    };
+
+    // False when index is not of the model the delegate draws, the row is then painted as text
+    virtual bool structure(const QModelIndex &index, Structure &s) const = 0;
+
+private:
+    void rendered();
+
+    RenderCache *m_cache;
+    mutable QPointer<QWidget> m_view; // Repainted when a render lands
+};